@@ -3,6 +3,7 @@ set(BENCHMARK_INSTALL_DIR ${CMAKE_SOURCE_DIR}/${CMAKE_BUILD_TYPE}-benchmark-${GI
 install(
 	FILES
 		${CMAKE_SOURCE_DIR}/build/src/benchmark/coroMutexBenchmark
+		${CMAKE_SOURCE_DIR}/build/src/benchmark/coreMicroBenchmark
 	DESTINATION ${BENCHMARK_INSTALL_DIR}
 	PERMISSIONS OWNER_EXECUTE OWNER_WRITE OWNER_READ
 )
@@ -13,6 +14,7 @@ install(
 		tools/gen_bench_graphic.py
 		tools/gen_bench_usage_diagram_comparison.py
 		tools/gen_bench_usage_diagram.py
+		tools/gen_open_loop_graphic.py
 		tools/gen_summary.py
 		tools/run_benchmark.sh
 		tools/run.sh
@@ -1,12 +1,38 @@
 #include "benchmark/coro.h"
 
+#include <atomic>
 #include <thread>
 #include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 
+#include "core/offload-blocking.h"
 #include "core/task-manager.h"
 
 #include <spdlog/spdlog.h>
 
+namespace
+{
+// Started and not yet returned coroutines, a respawned successor takes over the count of its predecessor
+std::atomic<int64_t> live { 0 };
+
+void launch(cs::task coro)
+{
+	live.fetch_add(1);
+	try
+	{
+		cs::taskManager::instance().execute(std::move(coro));
+	}
+	catch (...)
+	{
+		live.fetch_sub(1);
+		throw;
+	}
+}
+} // namespace
+
 // cs::task coroutine(cs::atomicMultipleCounter& counter, size_t id, std::atomic<bool>& running, cs::coroMutex& mtx, size_t counterIdx)
 // {
 // 	spdlog::debug("Coro [{}] starting", id);
@@ -44,24 +70,233 @@
 // 	co_return;
 // }
 
-cs::task coroutine(cs::atomicMultipleCounter& counter, size_t id, std::atomic<bool>& running, cs::coroMutex& mtx, size_t counterIdx)
+cs::coroMode cs::parseCoroMode(const std::string& name)
 {
-	if (!running)
-		co_return;
-	co_await mtx.lock();
-	counter.increment(counterIdx);
-	std::this_thread::sleep_for(std::chrono::milliseconds(1));
-	mtx.unlock();
-	cs::taskManager::instance().execute(coroutine(counter, id, running, mtx, counterIdx));
+	if (name == "respawn")
+		return coroMode::respawn;
+	if (name == "loop")
+		return coroMode::loop;
+	throw std::runtime_error("Unknown coroutine mode: " + name);
+}
+
+std::string cs::toString(coroMode mode)
+{
+	return mode == coroMode::loop ? "loop" : "respawn";
+}
+
+cs::task coroutine(cs::atomicMultipleCounter& counter, cs::latencyRecorder& latency, cs::workload& load, size_t id, std::atomic<bool>& running, cs::coroMutex& mtx, size_t counterIdx,
+	cs::coroMode mode)
+{
+	while (running)
+	{
+		auto requested = cs::latencyRecorder::clock_t::now();
+		co_await mtx.lock();
+		auto acquired = cs::latencyRecorder::clock_t::now();
+		counter.increment(counterIdx);
+		load.criticalSection(counterIdx);
+		auto released = cs::latencyRecorder::clock_t::now();
+		mtx.unlock();
+		latency.record(requested, acquired, released);
+		load.think();
+
+		if (mode == cs::coroMode::respawn)
+		{
+			cs::executor::current().execute(coroutine(counter, latency, load, id, running, mtx, counterIdx, mode));
+			co_return;
+		}
+		auto yielded = cs::latencyRecorder::clock_t::now();
+		co_await cs::yield();
+		latency.recordResume(yielded, cs::latencyRecorder::clock_t::now());
+	}
+	live.fetch_sub(1);
+}
+
+// Same iteration as above with the critical section delegated to the mutex holder
+cs::task runCoroutine(cs::atomicMultipleCounter& counter, cs::latencyRecorder& latency, cs::workload& load, size_t id, std::atomic<bool>& running, cs::coroMutex& mtx,
+	size_t counterIdx, cs::coroMode mode)
+{
+	while (running)
+	{
+		auto requested = cs::latencyRecorder::clock_t::now();
+		auto [acquired, released] = co_await mtx.run(
+			[&]()
+			{
+				auto acquired = cs::latencyRecorder::clock_t::now();
+				counter.increment(counterIdx);
+				load.criticalSection(counterIdx);
+				return std::make_pair(acquired, cs::latencyRecorder::clock_t::now());
+			});
+		latency.record(requested, acquired, released);
+		load.think();
+
+		if (mode == cs::coroMode::respawn)
+		{
+			cs::executor::current().execute(runCoroutine(counter, latency, load, id, running, mtx, counterIdx, mode));
+			co_return;
+		}
+		auto yielded = cs::latencyRecorder::clock_t::now();
+		co_await cs::yield();
+		latency.recordResume(yielded, cs::latencyRecorder::clock_t::now());
+	}
+	live.fetch_sub(1);
+}
+
+cs::task tableCoroutine(cs::atomicMultipleCounter& counter, cs::latencyRecorder& latency, cs::workload& load, size_t id, std::atomic<bool>& running, cs::coroLockTable& table,
+	size_t counterIdx, cs::coroMode mode)
+{
+	while (running)
+	{
+		auto requested = cs::latencyRecorder::clock_t::now();
+		co_await table.lock(counterIdx);
+		auto acquired = cs::latencyRecorder::clock_t::now();
+		counter.increment(counterIdx);
+		load.criticalSection(counterIdx);
+		auto released = cs::latencyRecorder::clock_t::now();
+		table.unlock(counterIdx);
+		latency.record(requested, acquired, released);
+		load.think();
+
+		if (mode == cs::coroMode::respawn)
+		{
+			cs::executor::current().execute(tableCoroutine(counter, latency, load, id, running, table, counterIdx, mode));
+			co_return;
+		}
+		auto yielded = cs::latencyRecorder::clock_t::now();
+		co_await cs::yield();
+		latency.recordResume(yielded, cs::latencyRecorder::clock_t::now());
+	}
+	live.fetch_sub(1);
 }
 
-cs::task coroutine(cs::atomicMultipleCounter& counter, size_t id, std::atomic<bool>& running, std::mutex& mtx, size_t counterIdx)
+template<typename Lockable>
+cs::task coroutine(cs::atomicMultipleCounter& counter, cs::latencyRecorder& latency, cs::workload& load, size_t id, std::atomic<bool>& running, Lockable& mtx, size_t counterIdx,
+	cs::coroMode mode, bool offload)
+{
+	auto iteration = [&]()
+	{
+		auto requested = cs::latencyRecorder::clock_t::now();
+		mtx.lock();
+		auto acquired = cs::latencyRecorder::clock_t::now();
+		counter.increment(counterIdx);
+		load.criticalSection(counterIdx);
+		auto released = cs::latencyRecorder::clock_t::now();
+		mtx.unlock();
+		latency.record(requested, acquired, released);
+	};
+
+	while (running)
+	{
+		if (offload)
+			co_await cs::offload_blocking(iteration);
+		else
+			iteration();
+		load.think();
+
+		if (mode == cs::coroMode::respawn)
+		{
+			cs::executor::current().execute(coroutine(counter, latency, load, id, running, mtx, counterIdx, mode, offload));
+			co_return;
+		}
+		auto yielded = cs::latencyRecorder::clock_t::now();
+		co_await cs::yield();
+		latency.recordResume(yielded, cs::latencyRecorder::clock_t::now());
+	}
+	live.fetch_sub(1);
+}
+
+cs::task spawnCoroutine(cs::atomicMultipleCounter& counter, size_t id, std::atomic<bool>& running, size_t counterIdx)
 {
 	if (!running)
+	{
+		live.fetch_sub(1);
 		co_return;
-	mtx.lock();
+	}
 	counter.increment(counterIdx);
-	std::this_thread::sleep_for(std::chrono::milliseconds(1));
-	mtx.unlock();
-	cs::taskManager::instance().execute(coroutine(counter, id, running, mtx, counterIdx));
-}
\ No newline at end of file
+	cs::executor::current().execute(spawnCoroutine(counter, id, running, counterIdx));
+}
+
+template cs::task coroutine(cs::atomicMultipleCounter&, cs::latencyRecorder&, cs::workload&, size_t, std::atomic<bool>&, std::mutex&, size_t, cs::coroMode, bool);
+template cs::task coroutine(cs::atomicMultipleCounter&, cs::latencyRecorder&, cs::workload&, size_t, std::atomic<bool>&, cs::ttasSpinlock&, size_t, cs::coroMode, bool);
+template cs::task coroutine(cs::atomicMultipleCounter&, cs::latencyRecorder&, cs::workload&, size_t, std::atomic<bool>&, cs::ticketLock&, size_t, cs::coroMode, bool);
+template cs::task coroutine(cs::atomicMultipleCounter&, cs::latencyRecorder&, cs::workload&, size_t, std::atomic<bool>&, cs::mcsLock&, size_t, cs::coroMode, bool);
+template cs::task coroutine(cs::atomicMultipleCounter&, cs::latencyRecorder&, cs::workload&, size_t, std::atomic<bool>&, cs::futexMutex&, size_t, cs::coroMode, bool);
+template cs::task coroutine(cs::atomicMultipleCounter&, cs::latencyRecorder&, cs::workload&, size_t, std::atomic<bool>&, std::shared_mutex&, size_t, cs::coroMode, bool);
+
+cs::task hogCoroutine(std::atomic<bool>& running, cs::coroMutex& mtx, std::chrono::nanoseconds work)
+{
+	while (running)
+	{
+		co_await mtx.lock();
+		cs::workload::spin(work);
+		mtx.unlock();
+	}
+	live.fetch_sub(1);
+}
+
+void startHogs(std::vector<cs::coroMutex>& mutexes, std::chrono::nanoseconds work, std::atomic<bool>& running)
+{
+	for (auto& mtx : mutexes)
+		launch(hogCoroutine(running, mtx, work));
+}
+
+int64_t liveCoroutines()
+{
+	return live.load();
+}
+
+bool waitCoroutines(std::chrono::milliseconds timeout)
+{
+	auto until = std::chrono::steady_clock::now() + timeout;
+	while (live.load() != 0)
+	{
+		if (std::chrono::steady_clock::now() >= until)
+			return false;
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return true;
+}
+
+void startCoroutines(size_t coroNumber, cs::atomicMultipleCounter& counter, cs::latencyRecorder& latency, cs::workload& load, std::atomic<bool>& running,
+	cs::syncTargets& targets, cs::coroMode mode, bool offload)
+{
+	auto start = [&](auto& primitives, size_t i, size_t idx)
+	{
+		if constexpr (std::is_same_v<std::decay_t<decltype(primitives[idx])>, cs::coroMutex>)
+			launch(coroutine(counter, latency, load, i, running, primitives[idx], idx, mode));
+		else
+			launch(coroutine(counter, latency, load, i, running, primitives[idx], idx, mode, offload));
+		SPDLOG_DEBUG("Started coroutine {} with target {}. counter idx: {}", i, targets.target, idx);
+	};
+
+	for (size_t i = 0; i < coroNumber; ++i)
+	{
+		try
+		{
+			size_t idx = i % counter.size();
+			if (targets.target == "spawn")
+				launch(spawnCoroutine(counter, i, running, idx));
+			else if (targets.target == "m")
+				start(targets.m, i, idx);
+			else if (targets.target == "cm")
+				start(targets.cm, i, idx);
+			else if (targets.target == "lt")
+				launch(tableCoroutine(counter, latency, load, i, running, *targets.lt, idx, mode));
+			else if (targets.target == "cmr")
+				launch(runCoroutine(counter, latency, load, i, running, targets.cm[idx], idx, mode));
+			else if (targets.target == "ttas")
+				start(targets.ttas, i, idx);
+			else if (targets.target == "ticket")
+				start(targets.ticket, i, idx);
+			else if (targets.target == "mcs")
+				start(targets.mcs, i, idx);
+			else if (targets.target == "futex")
+				start(targets.futex, i, idx);
+			else if (targets.target == "sm")
+				start(targets.sm, i, idx);
+		}
+		catch (const std::exception& e)
+		{
+			spdlog::error("Failed to start coroutine {}: {}", i, e.what());
+		}
+	}
+}
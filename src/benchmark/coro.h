@@ -1,11 +1,63 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
 #include <mutex>
+#include <string>
+#include <vector>
 
 #include "benchmark/counter/atomic-multiple-counter.h"
+#include "benchmark/latency/latency-recorder.h"
+#include "benchmark/locks/sync-targets.h"
+#include "benchmark/workload/workload.h"
 
 #include "core/coro-mutex.h"
 #include "core/task.h"
 
-cs::task coroutine(cs::atomicMultipleCounter& counter, size_t id, std::atomic<bool>& running, cs::coroMutex& mtx, size_t counterIdx);
-cs::task coroutine(cs::atomicMultipleCounter& counter, size_t id, std::atomic<bool>& running, std::mutex& mtx, size_t counterIdx);
\ No newline at end of file
+namespace cs
+{
+// respawn - every iteration ends by spawning a fresh coroutine, so frame allocation and scheduling are measured too,
+// loop - a coroutine iterates until stop and reschedules itself with co_await cs::yield()
+enum class coroMode
+{
+	respawn,
+	loop
+};
+
+// Throws std::runtime_error on an unknown mode name
+coroMode parseCoroMode(const std::string& name);
+std::string toString(coroMode mode);
+} // namespace cs
+
+cs::task coroutine(cs::atomicMultipleCounter& counter, cs::latencyRecorder& latency, cs::workload& load, size_t id, std::atomic<bool>& running, cs::coroMutex& mtx, size_t counterIdx,
+	cs::coroMode mode);
+
+// Blocking primitives (std::mutex, spinlocks, futex mutex, ...) hold the worker thread while waiting,
+// with offload the lock, critical section and unlock run on cs::blockingPool instead.
+// Instantiated in coro.cpp for every syncTargets primitive.
+template<typename Lockable>
+cs::task coroutine(cs::atomicMultipleCounter& counter, cs::latencyRecorder& latency, cs::workload& load, size_t id, std::atomic<bool>& running, Lockable& mtx, size_t counterIdx,
+	cs::coroMode mode, bool offload);
+
+// Spawn-rate target: every coroutine increments the counter and spawns its successor, no synchronization,
+// so the counter measures coroutine create/schedule/destroy throughput
+cs::task spawnCoroutine(cs::atomicMultipleCounter& counter, size_t id, std::atomic<bool>& running, size_t counterIdx);
+
+// Never suspends on its own: loops over an uncontended private mutex with work inside until stop,
+// it gives its worker back only when the executor budget forces a yield
+cs::task hogCoroutine(std::atomic<bool>& running, cs::coroMutex& mtx, std::chrono::nanoseconds work);
+
+// Spawns one hog coroutine per mutex
+void startHogs(std::vector<cs::coroMutex>& mutexes, std::chrono::nanoseconds work, std::atomic<bool>& running);
+
+// Coroutines started by startCoroutines and startHogs that have not returned yet,
+// frames still suspended on a mutex or queued on the pool are counted too
+int64_t liveCoroutines();
+
+// Waits for liveCoroutines() to drop to zero once running is cleared, the pools must keep running meanwhile.
+// Returns false on timeout
+bool waitCoroutines(std::chrono::milliseconds timeout);
+
+// Spawns coroNumber benchmark coroutines, coroutine i contends on primitive and counter i % shared objects number
+void startCoroutines(size_t coroNumber, cs::atomicMultipleCounter& counter, cs::latencyRecorder& latency, cs::workload& load, std::atomic<bool>& running,
+	cs::syncTargets& targets, cs::coroMode mode, bool offload);
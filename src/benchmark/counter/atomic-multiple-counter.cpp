@@ -3,58 +3,85 @@
 #include <spdlog/spdlog.h>
 
 #include <ctime>
-#include <numeric>
 
 using namespace cs;
 
-atomicMultipleCounter::atomicMultipleCounter(size_t counterCount)
-: counters_(counterCount)
+namespace
 {
-	for (auto& counter : counters_)
-	{
-		counter.store(0, std::memory_order_relaxed);
-	}
+std::atomic<size_t> nextThreadId { 0 };
+thread_local const size_t threadId = nextThreadId.fetch_add(1, std::memory_order_relaxed);
+} // namespace
+
+atomicMultipleCounter::atomicMultipleCounter(size_t counterCount, size_t shardCount)
+: counterCount_ { counterCount }
+, shardCount_ { shardCount == 0 ? 1 : shardCount }
+, slots_(counterCount_ * shardCount_)
+{ }
+
+std::atomic<int64_t>& atomicMultipleCounter::cell(size_t counter_index)
+{
+	if (shardCount_ == 1)
+		return slots_[counter_index].value;
+	return slots_[(threadId % shardCount_) * counterCount_ + counter_index].value;
 }
 
 void atomicMultipleCounter::increment(size_t counter_index)
 {
-	if (counter_index >= counters_.size())
+#ifndef NDEBUG
+	if (counter_index >= counterCount_)
 	{
-		spdlog::error("Failed to increment {} element. Counters number {}", counter_index, counters_.size());
+		spdlog::error("Failed to increment {} element. Counters number {}", counter_index, counterCount_);
 		return;
 	}
-	counters_[counter_index].fetch_add(1, std::memory_order_relaxed);
-	spdlog::trace("Incremented counter: {}, value: {}", counter_index, counters_[counter_index].load());
+#endif
+	[[maybe_unused]] int64_t value = cell(counter_index).fetch_add(1, std::memory_order_relaxed);
+	SPDLOG_TRACE("Incremented counter: {}, value: {}", counter_index, value + 1);
 }
 
 void atomicMultipleCounter::decrement(size_t counter_index)
 {
-	if (counter_index >= counters_.size())
+#ifndef NDEBUG
+	if (counter_index >= counterCount_)
 	{
-		spdlog::error("Failed to decrement {} element. Counters number {}", counter_index, counters_.size());
+		spdlog::error("Failed to decrement {} element. Counters number {}", counter_index, counterCount_);
 		return;
 	}
-	counters_[counter_index].fetch_sub(1, std::memory_order_relaxed);
-	spdlog::trace("Decremented counter: {}, value: {}", counter_index, counters_[counter_index].load());
+#endif
+	[[maybe_unused]] int64_t value = cell(counter_index).fetch_sub(1, std::memory_order_relaxed);
+	SPDLOG_TRACE("Decremented counter: {}, value: {}", counter_index, value - 1);
 }
 
 int64_t atomicMultipleCounter::get(size_t counter_index) const
 {
-	if (counter_index >= counters_.size())
+	if (counter_index >= counterCount_)
 	{
-		spdlog::error("Failed to get {} element. Counters number {}", counter_index, counters_.size());
+		spdlog::error("Failed to get {} element. Counters number {}", counter_index, counterCount_);
 		return 0;
 	}
-	return counters_[counter_index].load(std::memory_order_relaxed);
+	int64_t sum = 0;
+	for (size_t shard = 0; shard < shardCount_; ++shard)
+	{
+		sum += slots_[shard * counterCount_ + counter_index].value.load(std::memory_order_relaxed);
+	}
+	return sum;
 }
 
 int64_t atomicMultipleCounter::get_total() const
 {
-	return std::accumulate(counters_.begin(), counters_.end(), int64_t { 0 },
-		[](int64_t sum, const std::atomic<int64_t>& counter) { return sum + counter.load(std::memory_order_relaxed); });
+	int64_t sum = 0;
+	for (const auto& slot : slots_)
+	{
+		sum += slot.value.load(std::memory_order_relaxed);
+	}
+	return sum;
 }
 
 size_t atomicMultipleCounter::size() const
 {
-	return counters_.size();
-}
\ No newline at end of file
+	return counterCount_;
+}
+
+size_t atomicMultipleCounter::shards() const
+{
+	return shardCount_;
+}
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
 namespace cs
@@ -9,7 +11,11 @@ namespace cs
 class atomicMultipleCounter
 {
 public:
-	atomicMultipleCounter(size_t counterCount = 1);
+	static constexpr size_t cacheLineSize = 64;
+
+	// shardCount > 1 gives every thread its own row of cells (chosen once per thread),
+	// get/get_total sum the rows. Every cell occupies its own cache line.
+	atomicMultipleCounter(size_t counterCount = 1, size_t shardCount = 1);
 
 	atomicMultipleCounter(const atomicMultipleCounter&) = delete;
 	atomicMultipleCounter& operator= (const atomicMultipleCounter&) = delete;
@@ -21,8 +27,18 @@ public:
 	int64_t get_total() const;
 
 	size_t size() const;
+	size_t shards() const;
 
 private:
-	std::vector<std::atomic<int64_t>> counters_;
+	struct alignas(cacheLineSize) slot
+	{
+		std::atomic<int64_t> value { 0 };
+	};
+
+	std::atomic<int64_t>& cell(size_t counterIndex);
+
+	size_t counterCount_;
+	size_t shardCount_;
+	std::vector<slot> slots_;
 };
-} // namespace cs
\ No newline at end of file
+} // namespace cs
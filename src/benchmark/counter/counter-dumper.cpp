@@ -1,16 +1,20 @@
 #include "benchmark/counter/counter-dumper.h"
 
-#include <chrono>
-#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
 
 #include <spdlog/spdlog.h>
 
 using namespace cs;
 
-counterDumper::counterDumper(atomicMultipleCounter& counter, const std::string& filename, const std::chrono::milliseconds& interval)
+counterDumper::counterDumper(atomicMultipleCounter& counter, const std::string& filename, const std::chrono::milliseconds& interval, size_t ringBytes)
 : counter_ { counter }
 , filename_ { filename }
 , interval_ { interval }
+, recordSize_ { counter.size() + 2 }
+, ringRecords_ { std::max<size_t>(ringBytes / (recordSize_ * sizeof(int64_t)), 1) }
+, ring_(recordSize_ * ringRecords_)
 { }
 
 counterDumper::~counterDumper()
@@ -23,6 +27,17 @@ void counterDumper::start()
 	if (running_)
 		return;
 
+	out_.open(filename_, std::ios_base::binary | std::ios_base::trunc);
+	if (!out_.is_open())
+	{
+		spdlog::error("Failed to open file: {}", filename_);
+		return;
+	}
+
+	int64_t header[2] = { static_cast<int64_t>(counter_.size()), std::chrono::duration_cast<std::chrono::nanoseconds>(interval_).count() };
+	out_.write(magic, sizeof(magic));
+	out_.write(reinterpret_cast<const char*>(header), sizeof(header));
+
 	running_ = true;
 	startTime_ = std::chrono::steady_clock::now();
 	worker_ = std::thread(&counterDumper::worker, this);
@@ -30,33 +45,98 @@ void counterDumper::start()
 
 void counterDumper::stop()
 {
+	std::lock_guard<std::mutex> lock(mtx_);
+
 	running_ = false;
 	if (worker_.joinable())
 	{
 		worker_.join();
 	}
-	dump();
+	if (!out_.is_open())
+		return;
+
+	sample();
+	flush();
+	out_.close();
 }
 
 void counterDumper::worker()
 {
+	auto next = startTime_;
 	while (running_)
 	{
-		std::this_thread::sleep_for(interval_);
-		dump();
+		next += interval_;
+		std::this_thread::sleep_until(next);
+		if (!running_)
+			break;
+
+		sample();
+
+		// Skip ticks we have already missed instead of sampling in a burst
+		auto now = std::chrono::steady_clock::now();
+		if (now - next > interval_)
+			next += ((now - next) / interval_) * interval_;
+	}
+}
+
+void counterDumper::sample()
+{
+	int64_t* record = ring_.data() + ringCount_ * recordSize_;
+	record[0] = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime_).count();
+
+	int64_t total = 0;
+	for (size_t i = 0; i < counter_.size(); ++i)
+	{
+		record[i + 1] = counter_.get(i);
+		total += record[i + 1];
 	}
+	record[recordSize_ - 1] = total;
+
+	if (++ringCount_ == ringRecords_)
+		flush();
 }
 
-void counterDumper::dump()
+void counterDumper::flush()
 {
-	std::lock_guard<std::mutex> lock(mtx_);
+	if (ringCount_ == 0)
+		return;
 
-	auto now = std::chrono::steady_clock::now();
-	auto elapsed = now - startTime_;
+	out_.write(reinterpret_cast<const char*>(ring_.data()), static_cast<std::streamsize>(ringCount_ * recordSize_ * sizeof(int64_t)));
+	out_.flush();
+	ringCount_ = 0;
+}
 
-	std::ofstream out(filename_, std::ios_base::app);
-	if (out.is_open())
+bool counterDumper::convertToCsv(const std::string& binaryFilename, const std::string& csvFilename)
+{
+	std::ifstream in(binaryFilename, std::ios_base::binary);
+	if (!in.is_open())
+	{
+		spdlog::error("Failed to open file: {}", binaryFilename);
+		return false;
+	}
+
+	char fileMagic[sizeof(magic)];
+	int64_t header[2];
+	in.read(fileMagic, sizeof(fileMagic));
+	in.read(reinterpret_cast<char*>(header), sizeof(header));
+	if (!in || std::memcmp(fileMagic, magic, sizeof(magic)) != 0 || header[0] < 0)
 	{
+		spdlog::error("Not a counter dump: {}", binaryFilename);
+		return false;
+	}
+
+	std::ofstream out(csvFilename, std::ios_base::app);
+	if (!out.is_open())
+	{
+		spdlog::error("Failed to open file: {}", csvFilename);
+		return false;
+	}
+
+	std::vector<int64_t> record(static_cast<size_t>(header[0]) + 2);
+	while (in.read(reinterpret_cast<char*>(record.data()), static_cast<std::streamsize>(record.size() * sizeof(int64_t))))
+	{
+		std::chrono::nanoseconds elapsed { record[0] };
+
 		// Разбиваем время на компоненты
 		auto hours = std::chrono::duration_cast<std::chrono::hours>(elapsed);
 		elapsed -= hours;
@@ -70,19 +150,42 @@ void counterDumper::dump()
 		out << std::setfill('0') << std::setw(2) << hours.count() << ":" << std::setw(2) << minutes.count() << ":" << std::setw(2) << seconds.count() << "."
 				<< std::setw(3) << milliseconds.count() << ",";
 
-		// Записываем каждый счетчик
-		for (size_t i = 0; i < counter_.size(); ++i)
+		// Записываем каждый счетчик и общую сумму
+		for (size_t i = 1; i < record.size(); ++i)
 		{
-			if (i != 0)
+			if (i != 1)
 				out << ",";
-			out << counter_.get(i);
+			out << record[i];
 		}
+		out << "\n";
+	}
+	return true;
+}
+
+bool counterDumper::readTotals(const std::string& binaryFilename, std::vector<total>& totals)
+{
+	std::ifstream in(binaryFilename, std::ios_base::binary);
+	if (!in.is_open())
+	{
+		spdlog::error("Failed to open file: {}", binaryFilename);
+		return false;
+	}
 
-		// И общую сумму
-		out << "," << counter_.get_total() << "\n";
+	char fileMagic[sizeof(magic)];
+	int64_t header[2];
+	in.read(fileMagic, sizeof(fileMagic));
+	in.read(reinterpret_cast<char*>(header), sizeof(header));
+	if (!in || std::memcmp(fileMagic, magic, sizeof(magic)) != 0 || header[0] < 0)
+	{
+		spdlog::error("Not a counter dump: {}", binaryFilename);
+		return false;
 	}
-	else
+
+	totals.clear();
+	std::vector<int64_t> record(static_cast<size_t>(header[0]) + 2);
+	while (in.read(reinterpret_cast<char*>(record.data()), static_cast<std::streamsize>(record.size() * sizeof(int64_t))))
 	{
-		spdlog::error("Failed to open file: {}", filename_);
+		totals.push_back({ std::chrono::nanoseconds(record[0]), record.back() });
 	}
-}
\ No newline at end of file
+	return true;
+}
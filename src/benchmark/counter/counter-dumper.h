@@ -1,18 +1,37 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
 #include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "benchmark/counter/atomic-multiple-counter.h"
 
 namespace cs
 {
+// Samples the counters every interval (scheduled against the start time, so it does not drift)
+// into a preallocated ring and writes full rings to a binary file kept open for the whole run.
+// Binary layout: header { magic, counters number, interval ns }, then records
+// { elapsed ns, counter values..., total } of int64_t each. convertToCsv produces the text format
+// consumed by tools/gen_*.py.
 class counterDumper
 {
 public:
-	counterDumper(atomicMultipleCounter& counter, const std::string& filename, const std::chrono::milliseconds& interval);
+	static constexpr char magic[8] = { 'C', 'S', 'D', 'U', 'M', 'P', '0', '1' };
+
+	// Sum of all counters at a moment of the run
+	struct total
+	{
+		std::chrono::nanoseconds elapsed;
+		int64_t value;
+	};
+
+	// The ring holds as many records as fit in ringBytes (at least one), so its size does not grow with the counters number
+	counterDumper(atomicMultipleCounter& counter, const std::string& filename, const std::chrono::milliseconds& interval, size_t ringBytes = 1 << 20);
 	~counterDumper();
 
 	counterDumper(const counterDumper& other) = delete;
@@ -21,9 +40,13 @@ public:
 	void start();
 	void stop();
 
+	static bool convertToCsv(const std::string& binaryFilename, const std::string& csvFilename);
+	static bool readTotals(const std::string& binaryFilename, std::vector<total>& totals);
+
 private:
 	void worker();
-	void dump();
+	void sample();
+	void flush();
 
 private:
 	atomicMultipleCounter& counter_;
@@ -31,9 +54,15 @@ private:
 	std::string filename_;
 	std::chrono::milliseconds interval_;
 	std::thread worker_;
-	std::atomic<bool> running_ {false};
+	std::atomic<bool> running_ { false };
 	std::mutex mtx_;
 	std::chrono::time_point<std::chrono::steady_clock> startTime_;
+
+	std::ofstream out_;
+	size_t recordSize_;
+	size_t ringRecords_;
+	std::vector<int64_t> ring_;
+	size_t ringCount_ { 0 };
 };
 
-} // namespace cs
\ No newline at end of file
+} // namespace cs
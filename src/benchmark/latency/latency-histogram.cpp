@@ -0,0 +1,78 @@
+#include "benchmark/latency/latency-histogram.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+using namespace cs;
+
+size_t latencyHistogram::indexOf(uint64_t value)
+{
+	if (value < subBucketCount)
+		return static_cast<size_t>(value);
+
+	size_t shift = static_cast<size_t>(std::bit_width(value)) - subBucketBits;
+	return shift * subBucketHalf + static_cast<size_t>(value >> shift);
+}
+
+uint64_t latencyHistogram::highestEquivalentValue(size_t index)
+{
+	if (index < subBucketCount)
+		return index;
+
+	size_t shift = index / subBucketHalf - 1;
+	uint64_t subBucket = index - shift * subBucketHalf;
+	return ((subBucket + 1) << shift) - 1;
+}
+
+void latencyHistogram::record(uint64_t value)
+{
+	++buckets_[indexOf(value)];
+	++count_;
+	max_ = std::max(max_, value);
+}
+
+void latencyHistogram::merge(const latencyHistogram& other)
+{
+	for (size_t i = 0; i < bucketsCount; ++i)
+	{
+		buckets_[i] += other.buckets_[i];
+	}
+	count_ += other.count_;
+	max_ = std::max(max_, other.max_);
+}
+
+void latencyHistogram::reset()
+{
+	buckets_.fill(0);
+	count_ = 0;
+	max_ = 0;
+}
+
+uint64_t latencyHistogram::count() const
+{
+	return count_;
+}
+
+uint64_t latencyHistogram::max() const
+{
+	return max_;
+}
+
+uint64_t latencyHistogram::percentile(double percent) const
+{
+	if (count_ == 0)
+		return 0;
+
+	auto target = static_cast<uint64_t>(std::ceil(percent / 100.0 * static_cast<double>(count_)));
+	target = std::clamp<uint64_t>(target, 1, count_);
+
+	uint64_t seen = 0;
+	for (size_t i = 0; i < bucketsCount; ++i)
+	{
+		seen += buckets_[i];
+		if (seen >= target)
+			return std::min(highestEquivalentValue(i), max_);
+	}
+	return max_;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace cs
+{
+
+// Log-linear (HDR-style) histogram of nanosecond values: every power of two is split into
+// subBucketCount / 2 linear buckets, so any recorded value is reported within ~1.6%.
+// Not thread safe, meant to be owned by one thread and merged afterwards.
+class latencyHistogram
+{
+public:
+	static constexpr size_t subBucketBits = 7;
+	static constexpr size_t subBucketCount = size_t { 1 } << subBucketBits;
+	static constexpr size_t subBucketHalf = subBucketCount / 2;
+	static constexpr size_t bucketsCount = (64 - subBucketBits + 1) * subBucketHalf + subBucketHalf;
+
+	void record(uint64_t value);
+	void merge(const latencyHistogram& other);
+	void reset();
+
+	uint64_t count() const;
+	uint64_t max() const;
+	uint64_t percentile(double percent) const;
+
+private:
+	static size_t indexOf(uint64_t value);
+	static uint64_t highestEquivalentValue(size_t index);
+
+	std::array<uint64_t, bucketsCount> buckets_ {};
+	uint64_t count_ { 0 };
+	uint64_t max_ { 0 };
+};
+
+} // namespace cs
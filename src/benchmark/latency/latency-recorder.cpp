@@ -0,0 +1,149 @@
+#include "benchmark/latency/latency-recorder.h"
+
+#include <atomic>
+#include <fstream>
+
+#include <spdlog/spdlog.h>
+
+using namespace cs;
+
+namespace
+{
+std::atomic<uint64_t> nextRecorderId { 1 };
+} // namespace
+
+latencyRecorder::latencyRecorder()
+: id_ { nextRecorderId.fetch_add(1, std::memory_order_relaxed) }
+{ }
+
+latencyRecorder::threadHistograms& latencyRecorder::local()
+{
+	struct cache
+	{
+		uint64_t owner { 0 };
+		threadHistograms* histograms { nullptr };
+	};
+	static thread_local cache cached;
+
+	if (cached.owner != id_)
+	{
+		std::lock_guard<std::mutex> lock(mtx_);
+		histograms_.push_back(std::make_unique<threadHistograms>());
+		cached.owner = id_;
+		cached.histograms = histograms_.back().get();
+	}
+	return *cached.histograms;
+}
+
+void latencyRecorder::record(clock_t::time_point requested, clock_t::time_point acquired, clock_t::time_point released)
+{
+	if (!recording_.load(std::memory_order_relaxed))
+		return;
+	auto& histograms = local();
+	histograms.wait.record(std::chrono::duration_cast<std::chrono::nanoseconds>(acquired - requested).count());
+	histograms.hold.record(std::chrono::duration_cast<std::chrono::nanoseconds>(released - acquired).count());
+}
+
+void latencyRecorder::recordResume(clock_t::time_point yielded, clock_t::time_point resumed)
+{
+	if (!recording_.load(std::memory_order_relaxed))
+		return;
+	local().resume.record(std::chrono::duration_cast<std::chrono::nanoseconds>(resumed - yielded).count());
+}
+
+void latencyRecorder::recordResponse(clock_t::time_point intended, clock_t::time_point completed)
+{
+	if (!recording_.load(std::memory_order_relaxed))
+		return;
+	local().response.record(std::chrono::duration_cast<std::chrono::nanoseconds>(completed - intended).count());
+}
+
+void latencyRecorder::setRecording(bool enabled)
+{
+	recording_.store(enabled, std::memory_order_relaxed);
+}
+
+latencyHistogram latencyRecorder::mergedWait() const
+{
+	std::lock_guard<std::mutex> lock(mtx_);
+	latencyHistogram merged;
+	for (const auto& histograms : histograms_)
+	{
+		merged.merge(histograms->wait);
+	}
+	return merged;
+}
+
+latencyHistogram latencyRecorder::mergedHold() const
+{
+	std::lock_guard<std::mutex> lock(mtx_);
+	latencyHistogram merged;
+	for (const auto& histograms : histograms_)
+	{
+		merged.merge(histograms->hold);
+	}
+	return merged;
+}
+
+latencyHistogram latencyRecorder::mergedResume() const
+{
+	std::lock_guard<std::mutex> lock(mtx_);
+	latencyHistogram merged;
+	for (const auto& histograms : histograms_)
+	{
+		merged.merge(histograms->resume);
+	}
+	return merged;
+}
+
+latencyHistogram latencyRecorder::mergedResponse() const
+{
+	std::lock_guard<std::mutex> lock(mtx_);
+	latencyHistogram merged;
+	for (const auto& histograms : histograms_)
+	{
+		merged.merge(histograms->response);
+	}
+	return merged;
+}
+
+void latencyRecorder::dump(const std::string& filename) const
+{
+	auto wait = mergedWait();
+	auto hold = mergedHold();
+	auto resume = mergedResume();
+
+	spdlog::info("Lock acquisitions: {}", wait.count());
+	spdlog::info("Wait p50/p99/p999/max: {}/{}/{}/{} ns", wait.percentile(50), wait.percentile(99), wait.percentile(99.9), wait.max());
+	spdlog::info("Hold p50/p99/p999/max: {}/{}/{}/{} ns", hold.percentile(50), hold.percentile(99), hold.percentile(99.9), hold.max());
+	if (resume.count() != 0)
+		spdlog::info("Resume p50/p99/p999/max: {}/{}/{}/{} ns", resume.percentile(50), resume.percentile(99), resume.percentile(99.9), resume.max());
+
+	std::ofstream outfile(filename, std::ios::app);
+	if (outfile.is_open())
+	{
+		outfile << "=== Lock Latency ===" << "\n";
+		outfile << "Acquisitions: " << wait.count() << "\n";
+		outfile << "Wait p50 (ns): " << wait.percentile(50) << "\n";
+		outfile << "Wait p99 (ns): " << wait.percentile(99) << "\n";
+		outfile << "Wait p999 (ns): " << wait.percentile(99.9) << "\n";
+		outfile << "Wait max (ns): " << wait.max() << "\n";
+		outfile << "Hold p50 (ns): " << hold.percentile(50) << "\n";
+		outfile << "Hold p99 (ns): " << hold.percentile(99) << "\n";
+		outfile << "Hold p999 (ns): " << hold.percentile(99.9) << "\n";
+		outfile << "Hold max (ns): " << hold.max() << "\n";
+		if (resume.count() != 0)
+		{
+			outfile << "Resume p50 (ns): " << resume.percentile(50) << "\n";
+			outfile << "Resume p99 (ns): " << resume.percentile(99) << "\n";
+			outfile << "Resume p999 (ns): " << resume.percentile(99.9) << "\n";
+			outfile << "Resume max (ns): " << resume.max() << "\n";
+		}
+		outfile << "====================" << "\n\n";
+		outfile.close();
+	}
+	else
+	{
+		spdlog::error("Failed to open file {} for writing!", filename);
+	}
+}
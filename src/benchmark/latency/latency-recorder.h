@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "benchmark/latency/latency-histogram.h"
+
+namespace cs
+{
+
+// Collects lock wait (request -> acquisition) and hold (acquisition -> release) times, and
+// yield -> resume scheduling delays of looping coroutines, and open-loop response times (intended start -> release),
+// into per-thread histograms. Threads register on their first record, afterwards
+// recording touches only thread-owned memory. merge/dump must be called once workers are stopped.
+class latencyRecorder
+{
+public:
+	using clock_t = std::chrono::steady_clock;
+
+	latencyRecorder();
+
+	latencyRecorder(const latencyRecorder&) = delete;
+	latencyRecorder& operator= (const latencyRecorder&) = delete;
+
+	void record(clock_t::time_point requested, clock_t::time_point acquired, clock_t::time_point released);
+	void recordResume(clock_t::time_point yielded, clock_t::time_point resumed);
+	void recordResponse(clock_t::time_point intended, clock_t::time_point completed);
+
+	// While off, record calls are dropped, e.g. to keep a warm-up out of the histograms. On by default.
+	void setRecording(bool enabled);
+
+	latencyHistogram mergedWait() const;
+	latencyHistogram mergedHold() const;
+	latencyHistogram mergedResume() const;
+	latencyHistogram mergedResponse() const;
+
+	void dump(const std::string& filename) const;
+
+private:
+	struct threadHistograms
+	{
+		latencyHistogram wait;
+		latencyHistogram hold;
+		latencyHistogram resume;
+		latencyHistogram response;
+	};
+
+	threadHistograms& local();
+
+	const uint64_t id_;
+	std::atomic<bool> recording_ { true };
+	mutable std::mutex mtx_;
+	std::vector<std::unique_ptr<threadHistograms>> histograms_;
+};
+
+} // namespace cs
@@ -0,0 +1,47 @@
+#include "benchmark/locks/futex-mutex.h"
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace cs;
+
+namespace
+{
+void futexWait(std::atomic<uint32_t>& word, uint32_t expected)
+{
+	syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+}
+
+void futexWake(std::atomic<uint32_t>& word, int count)
+{
+	syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+}
+} // namespace
+
+void futexMutex::lock()
+{
+	uint32_t state = 0;
+	if (state_.compare_exchange_strong(state, 1, std::memory_order_acquire, std::memory_order_relaxed))
+		return;
+
+	if (state != 2)
+		state = state_.exchange(2, std::memory_order_acquire);
+	while (state != 0)
+	{
+		futexWait(state_, 2);
+		state = state_.exchange(2, std::memory_order_acquire);
+	}
+}
+
+bool futexMutex::try_lock()
+{
+	uint32_t state = 0;
+	return state_.compare_exchange_strong(state, 1, std::memory_order_acquire, std::memory_order_relaxed);
+}
+
+void futexMutex::unlock()
+{
+	if (state_.exchange(0, std::memory_order_release) == 2)
+		futexWake(state_, 1);
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace cs
+{
+
+// Three state futex mutex (0 - unlocked, 1 - locked, 2 - locked with waiters), Linux only
+class alignas(64) futexMutex
+{
+public:
+	void lock();
+	bool try_lock();
+	void unlock();
+
+private:
+	std::atomic<uint32_t> state_ { 0 };
+};
+
+} // namespace cs
@@ -0,0 +1,56 @@
+#include "benchmark/locks/mcs-lock.h"
+
+#include "benchmark/locks/spin-backoff.h"
+
+using namespace cs;
+
+namespace
+{
+thread_local mcsLock::node localNode;
+} // namespace
+
+void mcsLock::lock()
+{
+	lock(localNode);
+}
+
+void mcsLock::unlock()
+{
+	unlock(localNode);
+}
+
+void mcsLock::lock(node& self)
+{
+	self.next.store(nullptr, std::memory_order_relaxed);
+	self.locked.store(true, std::memory_order_relaxed);
+
+	node* prev = tail_.exchange(&self, std::memory_order_acq_rel);
+	if (!prev)
+		return;
+
+	prev->next.store(&self, std::memory_order_release);
+	spinBackoff backoff;
+	while (self.locked.load(std::memory_order_acquire))
+	{
+		backoff.pause();
+	}
+}
+
+void mcsLock::unlock(node& self)
+{
+	node* successor = self.next.load(std::memory_order_acquire);
+	if (!successor)
+	{
+		node* expected = &self;
+		if (tail_.compare_exchange_strong(expected, nullptr, std::memory_order_release, std::memory_order_relaxed))
+			return;
+
+		// A waiter swapped the tail but has not linked itself yet
+		spinBackoff backoff;
+		while (!(successor = self.next.load(std::memory_order_acquire)))
+		{
+			backoff.pause();
+		}
+	}
+	successor->locked.store(false, std::memory_order_release);
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <atomic>
+
+namespace cs
+{
+
+// MCS queue lock: every waiter spins on its own node. lock/unlock use a thread local node,
+// so a thread may hold one mcsLock at a time; pass nodes explicitly otherwise.
+class alignas(64) mcsLock
+{
+public:
+	struct alignas(64) node
+	{
+		std::atomic<node*> next { nullptr };
+		std::atomic<bool> locked { false };
+	};
+
+	void lock();
+	void unlock();
+
+	void lock(node& self);
+	void unlock(node& self);
+
+private:
+	std::atomic<node*> tail_ { nullptr };
+};
+
+} // namespace cs
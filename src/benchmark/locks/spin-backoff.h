@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <thread>
+
+namespace cs
+{
+
+inline void cpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#elif defined(__aarch64__)
+	asm volatile("yield" ::: "memory");
+#else
+	asm volatile("" ::: "memory");
+#endif
+}
+
+// Spin-then-yield wait used by the spinning baselines, so they stay usable when
+// the pool has more workers than cores
+class spinBackoff
+{
+public:
+	static constexpr uint32_t spinLimit = 64;
+
+	void pause()
+	{
+		if (++spins_ < spinLimit)
+		{
+			cpuRelax();
+			return;
+		}
+		spins_ = 0;
+		std::this_thread::yield();
+	}
+
+private:
+	uint32_t spins_ { 0 };
+};
+
+} // namespace cs
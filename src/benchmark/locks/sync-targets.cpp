@@ -0,0 +1,49 @@
+#include "benchmark/locks/sync-targets.h"
+
+#include <stdexcept>
+
+using namespace cs;
+
+syncTargets::syncTargets(const std::string& target, size_t sharedNumber, size_t lockStripes)
+: target { target }
+{
+	if (target == "m")
+		m = std::vector<std::mutex>(sharedNumber);
+	else if (target == "cm" || target == "cmr")
+		cm = std::vector<coroMutex>(sharedNumber);
+	else if (target == "ttas")
+		ttas = std::vector<ttasSpinlock>(sharedNumber);
+	else if (target == "ticket")
+		ticket = std::vector<ticketLock>(sharedNumber);
+	else if (target == "mcs")
+		mcs = std::vector<mcsLock>(sharedNumber);
+	else if (target == "futex")
+		futex = std::vector<futexMutex>(sharedNumber);
+	else if (target == "sm")
+		sm = std::vector<std::shared_mutex>(sharedNumber);
+	else if (target == "lt")
+		lt.emplace(lockStripes);
+	else if (target == "spawn")
+		return;
+	else
+		throw std::runtime_error("Unknown target: " + target);
+}
+
+bool syncTargets::isKnown(const std::string& target)
+{
+	return target == "m" || target == "cm" || target == "cmr" || target == "ttas" || target == "ticket" || target == "mcs" || target == "futex" || target == "sm" || target == "lt" || target == "spawn";
+}
+
+void syncTargets::setLockAffinity(const std::string& mode, size_t workers)
+{
+	if (mode != "none" && mode != "learn" && mode != "hint")
+		throw std::runtime_error("Unknown lock affinity: " + mode);
+
+	for (size_t i = 0; i < cm.size(); ++i)
+	{
+		if (mode == "learn")
+			cm[i].learnAffinity();
+		else if (mode == "hint")
+			cm[i].setAffinity(i % workers);
+	}
+}
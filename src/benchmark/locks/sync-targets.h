@@ -0,0 +1,46 @@
+#pragma once
+
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+#include "benchmark/locks/futex-mutex.h"
+#include "benchmark/locks/mcs-lock.h"
+#include "benchmark/locks/ticket-lock.h"
+#include "benchmark/locks/ttas-spinlock.h"
+
+#include "core/coro-lock-table.h"
+#include "core/coro-mutex.h"
+
+namespace cs
+{
+
+// Shared objects' synchronization primitives for one benchmark run, only the vector
+// of the selected target is populated
+struct syncTargets
+{
+	syncTargets(const std::string& target, size_t sharedNumber, size_t lockStripes = coroLockTable::defaultStripes);
+
+	// m - std::mutex, cm - coroMutex, cmr - coroMutex with delegated critical sections (run), ttas - TTAS spinlock, ticket - ticket lock,
+	// lt - coroLockTable keyed by shared object index, mcs - MCS queue lock, futex - futex mutex, sm - std::shared_mutex (exclusive),
+	// spawn - no primitive, coroutine spawn rate
+	static bool isKnown(const std::string& target);
+
+	// Home workers of the coroMutex targets: none, learn - the worker releasing a mutex first,
+	// hint - mutex i on worker i % workers. No-op for other targets.
+	void setLockAffinity(const std::string& mode, size_t workers);
+
+	std::string target;
+	std::vector<std::mutex> m;
+	std::vector<coroMutex> cm; // cm and cmr
+	std::vector<ttasSpinlock> ttas;
+	std::vector<ticketLock> ticket;
+	std::vector<mcsLock> mcs;
+	std::vector<futexMutex> futex;
+	std::vector<std::shared_mutex> sm;
+	std::optional<coroLockTable> lt;
+};
+
+} // namespace cs
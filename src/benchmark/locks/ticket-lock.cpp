@@ -0,0 +1,20 @@
+#include "benchmark/locks/ticket-lock.h"
+
+#include "benchmark/locks/spin-backoff.h"
+
+using namespace cs;
+
+void ticketLock::lock()
+{
+	uint32_t ticket = next_.fetch_add(1, std::memory_order_relaxed);
+	spinBackoff backoff;
+	while (serving_.load(std::memory_order_acquire) != ticket)
+	{
+		backoff.pause();
+	}
+}
+
+void ticketLock::unlock()
+{
+	serving_.store(serving_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace cs
+{
+
+// FIFO ticket lock, the ticket dispenser and the now-serving counter live on separate cache lines
+class alignas(64) ticketLock
+{
+public:
+	void lock();
+	void unlock();
+
+private:
+	alignas(64) std::atomic<uint32_t> next_ { 0 };
+	alignas(64) std::atomic<uint32_t> serving_ { 0 };
+};
+
+} // namespace cs
@@ -0,0 +1,29 @@
+#include "benchmark/locks/ttas-spinlock.h"
+
+#include "benchmark/locks/spin-backoff.h"
+
+using namespace cs;
+
+void ttasSpinlock::lock()
+{
+	spinBackoff backoff;
+	while (true)
+	{
+		if (!locked_.exchange(true, std::memory_order_acquire))
+			return;
+		while (locked_.load(std::memory_order_relaxed))
+		{
+			backoff.pause();
+		}
+	}
+}
+
+bool ttasSpinlock::try_lock()
+{
+	return !locked_.load(std::memory_order_relaxed) && !locked_.exchange(true, std::memory_order_acquire);
+}
+
+void ttasSpinlock::unlock()
+{
+	locked_.store(false, std::memory_order_release);
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <atomic>
+
+namespace cs
+{
+
+// Test-and-test-and-set spinlock
+class alignas(64) ttasSpinlock
+{
+public:
+	void lock();
+	bool try_lock();
+	void unlock();
+
+private:
+	std::atomic<bool> locked_ { false };
+};
+
+} // namespace cs
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <chrono>
 #include <csignal>
 #include <memory>
@@ -7,18 +8,29 @@
 #include <thread>
 #include <iostream>
 #include <fstream>
+#include <iomanip>
 
 #include <spdlog/spdlog.h>
+#include <spdlog/async.h>
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 
 #include "benchmark/counter/atomic-multiple-counter.h"
 #include "benchmark/counter/counter-dumper.h"
 #include "benchmark/coro.h"
-
+#include "benchmark/latency/latency-recorder.h"
+#include "benchmark/locks/sync-targets.h"
+#include "benchmark/openloop/open-loop-runner.h"
+#include "benchmark/perf/perf-counters.h"
+#include "benchmark/stats/steady-state.h"
+#include "benchmark/sweep/sweep-runner.h"
+
+#include "core/blocking-pool.h"
 #include "core/coro-mutex.h"
+#include "core/memory-accounting.h"
 #include "core/task-manager.h"
 #include "core/thread-pool.h"
+#include "core/trace.h"
 
 #include "optionsManager/options-manager.h"
 #include "optionsManager/register-option.h"
@@ -27,6 +39,15 @@ std::atomic<bool> running { true };
 std::shared_ptr<cs::threadPool> tp;
 std::optional<cs::atomicMultipleCounter> counter;
 std::optional<cs::counterDumper> counterDumper;
+std::optional<cs::workload> workload;
+std::optional<cs::syncTargets> targets;
+std::vector<cs::coroMutex> hogMutexes;
+std::optional<cs::perfCounters> runPerf;
+std::vector<cs::perfCounters::sample> workerPerf;
+// Taken while the coroutines still run, with memory-accounting only
+std::optional<cs::memoryAccounting::snapshot> memorySnapshot;
+thread_local std::optional<cs::perfCounters> threadPerf;
+cs::latencyRecorder latencyRecorder;
 
 void signalHandler(int signal);
 
@@ -36,8 +57,43 @@ REGISTER_OPTION("coro-number", 'c', coroNumberOption, size_t, 5);
 REGISTER_OPTION("shared-number", 's', sharedNumberOption, size_t, 1);
 REGISTER_OPTION("target", 't', targetOption, std::string, "cm");
 REGISTER_OPTION("dump-period", 'd', dumpPeriodOption, size_t, 1000);
+REGISTER_OPTION("warmup-discard", '\0', warmupDiscardOption, size_t, 1000);
+REGISTER_OPTION("steady-window", '\0', steadyWindowOption, size_t, 5);
+REGISTER_OPTION("steady-cv", '\0', steadyCvOption, double, 0.05);
 REGISTER_OPTION("working-time", 'w', workingTimeOption, size_t, 20);
 REGISTER_OPTION("output-dir", 'o', outputDirOption, std::string, ".");
+REGISTER_OPTION("log-queue", '\0', logQueueOption, size_t, 8192);
+REGISTER_OPTION("counter-shards", 'k', counterShardsOption, size_t, 1);
+REGISTER_OPTION("cs-spin-ns", '\0', csSpinNsOption, size_t, 0);
+REGISTER_OPTION("cs-lines", '\0', csLinesOption, size_t, 0);
+REGISTER_OPTION("cs-sleep-us", '\0', csSleepUsOption, size_t, 1000);
+REGISTER_OPTION("think-ns", '\0', thinkNsOption, size_t, 0);
+REGISTER_OPTION("cs-long-ratio", '\0', csLongRatioOption, double, 0.0);
+REGISTER_OPTION("cs-long-spin-ns", '\0', csLongSpinNsOption, size_t, 0);
+REGISTER_OPTION("sweep", 'S', sweepOption, bool, false);
+REGISTER_OPTION("sweep-threads", '\0', sweepThreadsOption, std::vector<uint64_t>, {});
+REGISTER_OPTION("sweep-coro", '\0', sweepCoroOption, std::vector<uint64_t>, {});
+REGISTER_OPTION("sweep-shared", '\0', sweepSharedOption, std::vector<uint64_t>, {});
+REGISTER_OPTION("sweep-targets", '\0', sweepTargetsOption, std::vector<std::string>, {});
+REGISTER_OPTION("warmup-time", '\0', warmupTimeOption, size_t, 1000);
+REGISTER_OPTION("trial-time", '\0', trialTimeOption, size_t, 1000);
+REGISTER_OPTION("trials", '\0', trialsOption, size_t, 5);
+REGISTER_OPTION("open-loop", '\0', openLoopOption, std::string, "");
+REGISTER_OPTION("open-rates", '\0', openRatesOption, std::vector<uint64_t>, {});
+REGISTER_OPTION("open-rate-start", '\0', openRateStartOption, size_t, 1000);
+REGISTER_OPTION("max-in-flight", '\0', maxInFlightOption, size_t, 100000);
+REGISTER_OPTION("coro-mode", '\0', coroModeOption, std::string, "respawn");
+REGISTER_OPTION("budget", '\0', budgetOption, size_t, 0);
+REGISTER_OPTION("blocking-threads", '\0', blockingThreadsOption, size_t, 0);
+REGISTER_OPTION("elastic-min", '\0', elasticMinOption, size_t, 1);
+REGISTER_OPTION("elastic-max", '\0', elasticMaxOption, size_t, 0);
+REGISTER_OPTION("idle-timeout", '\0', idleTimeoutOption, size_t, 100);
+REGISTER_OPTION("lock-stripes", '\0', lockStripesOption, size_t, 1024);
+REGISTER_OPTION("lock-affinity", '\0', lockAffinityOption, std::string, "none");
+REGISTER_OPTION("memory-accounting", '\0', memoryAccountingOption, bool, false);
+REGISTER_OPTION("trace", '\0', traceOption, bool, false);
+REGISTER_OPTION("hogs", '\0', hogsOption, size_t, 0);
+REGISTER_OPTION("hog-spin-ns", '\0', hogSpinNsOption, size_t, 1000);
 
 
 void setUpOptions(cs::optionsParser& parser);
@@ -45,15 +101,30 @@ void serializeOptions(cs::optionsManager& options);
 
 std::string getLogFilesBase();
 std::string getCounterLogFilePath();
+std::string getCounterDumpFilePath();
 std::string getLogFilePath();
 std::string getUsageFilePath();
+std::string getLatencyFilePath();
+std::string getSweepJsonFilePath();
+std::string getSweepCsvFilePath();
+std::string getTraceFilePath();
+std::string getOpenLoopJsonFilePath();
+std::string getOpenLoopCsvFilePath();
+std::string getSummaryFilePath();
 
 std::string logFilesBase;
 
 void initLogger();
 
+cs::workload::config getWorkloadConfig();
+
+int runSweep();
+int runOpenLoop();
+
+void writeSummary();
+
 void dumpUsage(rusage& startUsage, rusage& endUsage, std::chrono::time_point<std::chrono::high_resolution_clock> start,
-	std::chrono::time_point<std::chrono::high_resolution_clock> end);
+	std::chrono::time_point<std::chrono::high_resolution_clock> end, const cs::perfCounters::sample& runSample);
 
 int main(int argc, char* argv[])
 {
@@ -79,7 +150,25 @@ int main(int argc, char* argv[])
 	spdlog::info("  shared-number (-s): {}", sharedNumberOption);
 	spdlog::info("  target (-t): {}", targetOption);
 	spdlog::info("  dump-period (-d): {} ms", dumpPeriodOption);
+	spdlog::info("  warmup-discard: {} ms, steady-window: {} intervals, steady-cv: {}", warmupDiscardOption, steadyWindowOption, steadyCvOption);
 	spdlog::info("  working-time (-w): {} seconds", workingTimeOption);
+	spdlog::info("  counter-shards (-k): {}", counterShardsOption);
+	spdlog::info("  log-queue: {}", logQueueOption);
+	spdlog::info("  coro-mode: {}", coroModeOption);
+	spdlog::info("  budget: {}, hogs: {}, hog-spin: {} ns", budgetOption, hogsOption, hogSpinNsOption);
+	spdlog::info("  blocking-threads: {}", blockingThreadsOption);
+	spdlog::info("  lock-affinity: {}", lockAffinityOption);
+	spdlog::info("  lock-stripes: {}", lockStripesOption);
+	spdlog::info("  memory-accounting: {}", memoryAccountingOption);
+	spdlog::info("  trace: {}", traceOption);
+	if (elasticMaxOption != 0)
+		spdlog::info("  elastic pool: {}..{} workers, idle timeout {} ms", elasticMinOption, elasticMaxOption, idleTimeoutOption);
+	spdlog::info("  workload: cs-spin {} ns, cs-lines {}, cs-sleep {} us, think {} ns, long cs {} ns with ratio {}", csSpinNsOption, csLinesOption,
+		csSleepUsOption, thinkNsOption, csLongSpinNsOption, csLongRatioOption);
+	spdlog::info("  sweep (-S): {}", sweepOption);
+	if (!openLoopOption.empty())
+		spdlog::info("  open loop: {} arrivals, {} rates from {}/s, max in flight {}", openLoopOption, openRatesOption.empty() ? "doubling" : "listed",
+			openRatesOption.empty() ? openRateStartOption : openRatesOption.front(), maxInFlightOption);
 
 	if (helpOption)
 	{
@@ -88,17 +177,62 @@ int main(int argc, char* argv[])
 		return 0;
 	}
 
+	// Before any frame or queue exists, so the counts cover the whole run
+	if (memoryAccountingOption && !cs::memoryAccounting::compiled)
+		spdlog::warn("Built without BUILD_MEMORY_ACCOUNTING, no memory counts will be written");
+	cs::memoryAccounting::enable(memoryAccountingOption);
+
+	// Every taskManager::init (including the sweep's) applies it to the new pool
+	cs::taskManager::instance().setBudget(budgetOption);
+
+	if (sweepOption)
+	{
+		return runSweep();
+	}
+
+	if (!openLoopOption.empty())
+	{
+		return runOpenLoop();
+	}
+
 	// initialization
 	spdlog::info("Initializing components");
+	cs::coroMode coroMode;
 	try
 	{
-		counter.emplace(sharedNumberOption);
-		spdlog::debug("Counter initialized with shared objects number: {}", sharedNumberOption);
+		coroMode = cs::parseCoroMode(coroModeOption);
 
-		counterDumper.emplace(*counter, getCounterLogFilePath(), std::chrono::milliseconds(dumpPeriodOption));
-		spdlog::debug("Counter initialized with dump period: {} ms, and filepath: {}", dumpPeriodOption, getCounterLogFilePath());
+		targets.emplace(targetOption, sharedNumberOption, lockStripesOption);
+		targets->setLockAffinity(lockAffinityOption, threadsNumberOption);
+		spdlog::debug("Sync targets initialized: {}", targetOption);
+		if (targets->lt)
+			spdlog::info("Lock table: {} stripes, {} bytes for {} keys", targets->lt->stripesCount(), targets->lt->memoryUsage(), sharedNumberOption);
+
+		counter.emplace(sharedNumberOption, counterShardsOption);
+		spdlog::debug("Counter initialized with shared objects number: {}, shards: {}", sharedNumberOption, counterShardsOption);
+
+		counterDumper.emplace(*counter, getCounterDumpFilePath(), std::chrono::milliseconds(dumpPeriodOption));
+		spdlog::debug("Counter initialized with dump period: {} ms, and filepath: {}", dumpPeriodOption, getCounterDumpFilePath());
+
+		workload.emplace(getWorkloadConfig(), sharedNumberOption);
+		spdlog::debug("Workload initialized");
 
 		tp = std::make_shared<cs::threadPool>(threadsNumberOption);
+		if (elasticMaxOption != 0)
+			tp->setElastic({ elasticMinOption, elasticMaxOption, std::chrono::milliseconds(idleTimeoutOption) });
+		workerPerf.resize(tp->capacity());
+		tp->setWorkerHooks(
+			[](size_t)
+			{
+				threadPerf.emplace(false);
+				threadPerf->start();
+			},
+			[](size_t idx)
+			{
+				// Elastic pools reuse indices of retired workers
+				workerPerf[idx] += threadPerf->stop();
+				threadPerf.reset();
+			});
 		spdlog::debug("Thread pool initialized with {} threads", threadsNumberOption);
 
 		cs::taskManager::instance().init(tp);
@@ -110,36 +244,33 @@ int main(int argc, char* argv[])
 		return 1;
 	}
 
-	std::vector<std::mutex> mtxVec(sharedNumberOption);
-	std::vector<cs::coroMutex> coroMtxVec(sharedNumberOption);
+	if (traceOption)
+	{
+		if (!cs::trace::compiled)
+			spdlog::warn("Built without BUILD_TRACE, no trace will be written");
+		cs::trace::enable(true);
+	}
+
 	// workers start
+	runPerf.emplace(true);
+	if (!runPerf->available())
+		spdlog::warn("perf_event_open is unavailable, hardware counters will not be reported");
+	runPerf->start();
 	counterDumper->start();
 
 	spdlog::info("Starting {} threads", threadsNumberOption);
+	if (blockingThreadsOption != 0)
+		cs::blockingPool::instance().start(blockingThreadsOption);
 	tp->start();
 
 	// coroutines start
 	spdlog::info("Starting {} coroutines", coroNumberOption);
-	for (size_t i = 0; i < coroNumberOption; ++i)
+	startCoroutines(coroNumberOption, *counter, latencyRecorder, *workload, running, *targets, coroMode, blockingThreadsOption != 0);
+	if (hogsOption != 0)
 	{
-		try
-		{
-			size_t idx = i % sharedNumberOption;
-			if (targetOption == "m")
-			{
-				cs::taskManager::instance().execute(coroutine(*counter, i, running, mtxVec[idx], idx));
-				spdlog::debug("Started coroutine {} with std::mutex. counter idx: {}", i, idx);
-			}
-			else
-			{
-				cs::taskManager::instance().execute(coroutine(*counter, i, running, coroMtxVec[idx], idx));
-				spdlog::debug("Started coroutine {} with coroMutex. counter idx: {}", i, idx);
-			}
-		}
-		catch (const std::exception& e)
-		{
-			spdlog::error("Failed to start coroutine {}: {}", i, e.what());
-		}
+		spdlog::info("Starting {} hog coroutines", hogsOption);
+		hogMutexes = std::vector<cs::coroMutex>(hogsOption);
+		startHogs(hogMutexes, std::chrono::nanoseconds(hogSpinNsOption), running);
 	}
 
 
@@ -148,15 +279,34 @@ int main(int argc, char* argv[])
 	std::this_thread::sleep_for(std::chrono::seconds(workingTimeOption));
 
 	// finish
+	if (memoryAccountingOption && cs::memoryAccounting::compiled)
+		memorySnapshot = cs::memoryAccounting::take();
 	spdlog::info("Shutting down");
 	running = false;
+	if (!waitCoroutines(std::chrono::seconds(5)))
+		spdlog::warn("{} coroutines did not return within 5 s, their frames are leaked", liveCoroutines());
+	// Offloaded calls still in flight resume their coroutines on tp
+	cs::blockingPool::instance().stop();
 	tp->stop();
 	counterDumper->stop();
+	auto runSample = runPerf->stop();
+	cs::trace::enable(false);
 
 	getrusage(RUSAGE_SELF, &endUsage);
 	auto end = std::chrono::high_resolution_clock::now();
 
-	dumpUsage(startUsage, endUsage, start, end);
+	dumpUsage(startUsage, endUsage, start, end, runSample);
+	latencyRecorder.dump(getLatencyFilePath());
+	cs::counterDumper::convertToCsv(getCounterDumpFilePath(), getCounterLogFilePath());
+	writeSummary();
+	if (traceOption && cs::trace::compiled)
+	{
+		std::ofstream traceFile(getTraceFilePath());
+		if (traceFile.is_open())
+			cs::trace::writeChrome(traceFile);
+		else
+			spdlog::error("Failed to open file {} for writing!", getTraceFilePath());
+	}
 
 	spdlog::info("Benchmark finished successfully");
 	spdlog::shutdown();
@@ -170,6 +320,7 @@ void signalHandler(int signal)
 		spdlog::info("Got SIGTERM");
 
 		running = false;
+		cs::blockingPool::instance().stop();
 		if (tp)
 		{
 			tp->stop();
@@ -177,7 +328,10 @@ void signalHandler(int signal)
 		if (counter)
 		{
 			counterDumper->stop();
+			cs::counterDumper::convertToCsv(getCounterDumpFilePath(), getCounterLogFilePath());
 		}
+		// Drains the async logger queue
+		spdlog::shutdown();
 		std::exit(0);
 	}
 }
@@ -188,10 +342,48 @@ void setUpOptions(cs::optionsParser& parser)
 	parser.addOption(threadsNumberOptionName, threadsNumberOptionShortName, "Thread pool for coro execution size", true);
 	parser.addOption(coroNumberOptionName, coroNumberOptionShortName, "Coroutines number", true);
 	parser.addOption(sharedNumberOptionName, sharedNumberOptionShortName, "Number of shared objects", true);
-	parser.addOption(targetOptionName, targetOptionShortName, "Target sync prim (m - std::mutex, cm - coroMutex)", true);
+	parser.addOption(targetOptionName, targetOptionShortName, "Target sync prim (m - std::mutex, cm - coroMutex, cmr - coroMutex run() (delegated critical section), ttas - TTAS spinlock, ticket - ticket lock, mcs - MCS lock, futex - futex mutex, sm - std::shared_mutex, lt - striped coroLockTable, spawn - coroutine spawn rate)", true);
 	parser.addOption(dumpPeriodOptionName, dumpPeriodOptionShortName, "Period to dump atomic counter, as ms", true);
+	parser.addOption(warmupDiscardOptionName, warmupDiscardOptionShortName, "Counter intervals starting before this are left out of the .summary, as ms", true);
+	parser.addOption(steadyWindowOptionName, steadyWindowOptionShortName, "Consecutive counter intervals that must meet steady-cv to start the steady state", true);
+	parser.addOption(steadyCvOptionName, steadyCvOptionShortName, "Coefficient of variation of the steady-window intervals regarded as steady", true);
 	parser.addOption(workingTimeOptionName, workingTimeOptionShortName, "Time to work, as seconds (inf - infinite loop)", true);
 	parser.addOption(outputDirOptionName, outputDirOptionShortName, "Time to work, as seconds (inf - infinite loop)", true);
+	parser.addOption(logQueueOptionName, logQueueOptionShortName, "Async logger queue, as messages (preallocated, the oldest are dropped when it is full)", true);
+	parser.addOption(counterShardsOptionName, counterShardsOptionShortName, "Per-thread counter shards (1 - single shared cell per counter)", true);
+	parser.addOption(csSpinNsOptionName, csSpinNsOptionShortName, "Calibrated CPU spin inside the critical section, as ns", true);
+	parser.addOption(csLinesOptionName, csLinesOptionShortName, "Cache lines of shared object state written inside the critical section", true);
+	parser.addOption(csSleepUsOptionName, csSleepUsOptionShortName, "Sleep inside the critical section, as us (0 - no sleep)", true);
+	parser.addOption(thinkNsOptionName, thinkNsOptionShortName, "Calibrated CPU spin after releasing the lock, as ns", true);
+	parser.addOption(csLongRatioOptionName, csLongRatioOptionShortName, "Share of critical sections spinning cs-long-spin-ns instead of cs-spin-ns", true);
+	parser.addOption(csLongSpinNsOptionName, csLongSpinNsOptionShortName, "CPU spin of long critical sections, as ns", true);
+	parser.addOption(sweepOptionName, sweepOptionShortName, "Run every sweep-* combination in this process and write _sweep.json/_sweep.csv");
+	parser.addOption(sweepThreadsOptionName, sweepThreadsOptionShortName, "Sweep: comma separated thread pool sizes (default threads-number)", true);
+	parser.addOption(sweepCoroOptionName, sweepCoroOptionShortName, "Sweep: comma separated coroutines numbers (default coro-number)", true);
+	parser.addOption(sweepSharedOptionName, sweepSharedOptionShortName, "Sweep: comma separated shared objects numbers (default shared-number)", true);
+	parser.addOption(sweepTargetsOptionName, sweepTargetsOptionShortName, "Sweep: comma separated targets (default target)", true);
+	parser.addOption(warmupTimeOptionName, warmupTimeOptionShortName, "Sweep and open loop: warm-up before the first trial of every point, as ms", true);
+	parser.addOption(trialTimeOptionName, trialTimeOptionShortName, "Sweep and open loop: single trial duration, as ms", true);
+	parser.addOption(trialsOptionName, trialsOptionShortName, "Sweep: trials per point", true);
+	parser.addOption(elasticMinOptionName, elasticMinOptionShortName, "Elastic pool: minimum workers", true);
+	parser.addOption(elasticMaxOptionName, elasticMaxOptionShortName, "Elastic pool: maximum workers (0 - fixed pool of threads-number workers)", true);
+	parser.addOption(idleTimeoutOptionName, idleTimeoutOptionShortName, "Elastic pool: idle time before a worker retires, as ms", true);
+	parser.addOption(blockingThreadsOptionName, blockingThreadsOptionShortName, "Run blocking targets' lock/critical section/unlock on a blocking pool of this size (0 - on the pool workers)", true);
+	parser.addOption(budgetOptionName, budgetOptionShortName, "Uncontended coroMutex locks a coroutine may take per resume before it is made to yield (0 - unlimited)", true);
+	parser.addOption(lockStripesOptionName, lockStripesOptionShortName, "Stripes of the lt target's lock table (rounded up to a power of two)", true);
+	parser.addOption(lockAffinityOptionName, lockAffinityOptionShortName,
+		"coroMutex home workers (none, learn - the worker releasing a mutex first, hint - mutex i on worker i % threads)", true);
+	parser.addOption(memoryAccountingOptionName, memoryAccountingOptionShortName, "Count coroutine frames and queue blocks, written to the .usage file (needs -DBUILD_MEMORY_ACCOUNTING=ON)");
+	parser.addOption(traceOptionName, traceOptionShortName, "Record scheduling and lock events, written to .trace.json (Chrome/Perfetto, needs -DBUILD_TRACE=ON)");
+	parser.addOption(hogsOptionName, hogsOptionShortName, "Extra coroutines looping on private coroMutexes without ever suspending", true);
+	parser.addOption(hogSpinNsOptionName, hogSpinNsOptionShortName, "CPU spin per hog iteration, as ns", true);
+	parser.addOption(openLoopOptionName, openLoopOptionShortName,
+		"Open-loop load instead of the coroutines (constant, poisson arrivals), sweeps the rate to saturation and writes _open_loop.json/_open_loop.csv",
+		true);
+	parser.addOption(openRatesOptionName, openRatesOptionShortName, "Open loop: comma separated arrival rates, as requests/s (default doubling from open-rate-start)", true);
+	parser.addOption(openRateStartOptionName, openRateStartOptionShortName, "Open loop: first rate of the doubling sweep, as requests/s", true);
+	parser.addOption(maxInFlightOptionName, maxInFlightOptionShortName, "Open loop: requests in flight that mark the rate as saturated", true);
+	parser.addOption(coroModeOptionName, coroModeOptionShortName, "Coroutine iteration (respawn - spawn a new coroutine per iteration, loop - reschedule the same coroutine)", true);
 }
 
 void serializeOptions(cs::optionsManager& options)
@@ -202,8 +394,43 @@ void serializeOptions(cs::optionsManager& options)
 	sharedNumberOption = options.getUInt64(sharedNumberOptionName, sharedNumberOption);
 	targetOption = options.getString(targetOptionName, targetOption);
 	dumpPeriodOption = options.getUInt64(dumpPeriodOptionName, dumpPeriodOption);
+	warmupDiscardOption = options.getUInt64(warmupDiscardOptionName, warmupDiscardOption);
+	steadyWindowOption = options.getUInt64(steadyWindowOptionName, steadyWindowOption);
+	steadyCvOption = options.getDouble(steadyCvOptionName, steadyCvOption);
 	workingTimeOption = options.getUInt64(workingTimeOptionName, workingTimeOption);
 	outputDirOption = options.getString(outputDirOptionName, outputDirOption);
+	logQueueOption = options.getUInt64(logQueueOptionName, logQueueOption);
+	counterShardsOption = options.getUInt64(counterShardsOptionName, counterShardsOption);
+	csSpinNsOption = options.getUInt64(csSpinNsOptionName, csSpinNsOption);
+	csLinesOption = options.getUInt64(csLinesOptionName, csLinesOption);
+	csSleepUsOption = options.getUInt64(csSleepUsOptionName, csSleepUsOption);
+	thinkNsOption = options.getUInt64(thinkNsOptionName, thinkNsOption);
+	csLongRatioOption = options.getDouble(csLongRatioOptionName, csLongRatioOption);
+	csLongSpinNsOption = options.getUInt64(csLongSpinNsOptionName, csLongSpinNsOption);
+	sweepOption = options.getBool(sweepOptionName, sweepOption);
+	sweepThreadsOption = options.getUInt64List(sweepThreadsOptionName, { threadsNumberOption });
+	sweepCoroOption = options.getUInt64List(sweepCoroOptionName, { coroNumberOption });
+	sweepSharedOption = options.getUInt64List(sweepSharedOptionName, { sharedNumberOption });
+	sweepTargetsOption = options.getStringList(sweepTargetsOptionName, { targetOption });
+	warmupTimeOption = options.getUInt64(warmupTimeOptionName, warmupTimeOption);
+	trialTimeOption = options.getUInt64(trialTimeOptionName, trialTimeOption);
+	trialsOption = options.getUInt64(trialsOptionName, trialsOption);
+	openLoopOption = options.getString(openLoopOptionName, openLoopOption);
+	openRatesOption = options.getUInt64List(openRatesOptionName, openRatesOption);
+	openRateStartOption = options.getUInt64(openRateStartOptionName, openRateStartOption);
+	maxInFlightOption = options.getUInt64(maxInFlightOptionName, maxInFlightOption);
+	coroModeOption = options.getString(coroModeOptionName, coroModeOption);
+	budgetOption = options.getUInt64(budgetOptionName, budgetOption);
+	blockingThreadsOption = options.getUInt64(blockingThreadsOptionName, blockingThreadsOption);
+	elasticMinOption = options.getUInt64(elasticMinOptionName, elasticMinOption);
+	elasticMaxOption = options.getUInt64(elasticMaxOptionName, elasticMaxOption);
+	idleTimeoutOption = options.getUInt64(idleTimeoutOptionName, idleTimeoutOption);
+	lockStripesOption = options.getUInt64(lockStripesOptionName, lockStripesOption);
+	lockAffinityOption = options.getString(lockAffinityOptionName, lockAffinityOption);
+	memoryAccountingOption = options.getBool(memoryAccountingOptionName, memoryAccountingOption);
+	traceOption = options.getBool(traceOptionName, traceOption);
+	hogsOption = options.getUInt64(hogsOptionName, hogsOption);
+	hogSpinNsOption = options.getUInt64(hogSpinNsOptionName, hogSpinNsOption);
 }
 
 std::string getLogFilesBase()
@@ -234,6 +461,11 @@ std::string getCounterLogFilePath()
 	return outputDirOption + "/" + logFilesBase + ".csv";
 }
 
+std::string getCounterDumpFilePath()
+{
+	return outputDirOption + "/" + logFilesBase + ".bin";
+}
+
 std::string getLogFilePath()
 {
 	return outputDirOption + "/" + logFilesBase + ".log";
@@ -244,6 +476,41 @@ std::string getUsageFilePath()
 	return outputDirOption + "/" + logFilesBase + ".usage";
 }
 
+std::string getLatencyFilePath()
+{
+	return outputDirOption + "/" + logFilesBase + ".latency";
+}
+
+std::string getSweepJsonFilePath()
+{
+	return outputDirOption + "/" + logFilesBase + "_sweep.json";
+}
+
+std::string getSweepCsvFilePath()
+{
+	return outputDirOption + "/" + logFilesBase + "_sweep.csv";
+}
+
+std::string getSummaryFilePath()
+{
+	return outputDirOption + "/" + logFilesBase + ".summary";
+}
+
+std::string getOpenLoopJsonFilePath()
+{
+	return outputDirOption + "/" + logFilesBase + "_open_loop.json";
+}
+
+std::string getOpenLoopCsvFilePath()
+{
+	return outputDirOption + "/" + logFilesBase + "_open_loop.csv";
+}
+
+std::string getTraceFilePath()
+{
+	return outputDirOption + "/" + logFilesBase + ".trace.json";
+}
+
 void initLogger()
 {
 	try
@@ -252,9 +519,14 @@ void initLogger()
 		auto file_sink = std::make_shared<spdlog::sinks::basic_file_sink_mt>(getLogFilePath(), true);
 
 		std::vector<spdlog::sink_ptr> sinks { console_sink, file_sink };
-		auto logger = std::make_shared<spdlog::logger>("main", begin(sinks), end(sinks));
-
-		logger->set_level(spdlog::level::debug);
+		// Callers only format and enqueue, one thread writes the sinks: a worker never waits for the console or the disk,
+		// rather the oldest message is dropped
+		spdlog::init_thread_pool(std::max<size_t>(logQueueOption, 1), 1);
+		auto logger = std::make_shared<spdlog::async_logger>("main", begin(sinks), end(sinks), spdlog::thread_pool(),
+			spdlog::async_overflow_policy::overrun_oldest);
+
+		logger->set_level(static_cast<spdlog::level::level_enum>(SPDLOG_ACTIVE_LEVEL));
+		logger->flush_on(spdlog::level::err);
 		spdlog::set_default_logger(logger);
 	}
 	catch (const spdlog::spdlog_ex& ex)
@@ -265,7 +537,7 @@ void initLogger()
 }
 
 void dumpUsage(rusage& startUsage, rusage& endUsage, std::chrono::time_point<std::chrono::high_resolution_clock> start,
-	std::chrono::time_point<std::chrono::high_resolution_clock> end)
+	std::chrono::time_point<std::chrono::high_resolution_clock> end, const cs::perfCounters::sample& runSample)
 {
 	int64_t userTime = (endUsage.ru_utime.tv_sec - startUsage.ru_utime.tv_sec) * INT64_C(1000000);
 	userTime += (endUsage.ru_utime.tv_usec - startUsage.ru_utime.tv_usec);
@@ -276,9 +548,28 @@ void dumpUsage(rusage& startUsage, rusage& endUsage, std::chrono::time_point<std
 	auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
 	int64_t wallTime = duration.count();
 
+	int64_t maxRss = endUsage.ru_maxrss;
+	int64_t voluntarySwitches = endUsage.ru_nvcsw - startUsage.ru_nvcsw;
+	int64_t involuntarySwitches = endUsage.ru_nivcsw - startUsage.ru_nivcsw;
+
 	spdlog::info("Wall Time: {} μs", wallTime);
 	spdlog::info("User Time: {} μs", userTime);
 	spdlog::info("System Time: {} μs", systemTime);
+	spdlog::info("Max RSS: {} KB", maxRss);
+	spdlog::info("Context Switches: {} voluntary, {} involuntary", voluntarySwitches, involuntarySwitches);
+
+	auto writePerf = [](std::ofstream& out, const cs::perfCounters::sample& sample)
+	{
+		for (size_t i = 0; i < cs::perfCounters::eventsCount; ++i)
+		{
+			auto e = static_cast<cs::perfCounters::event>(i);
+			out << cs::perfCounters::name(e) << ": ";
+			if (sample.valid[i])
+				out << sample.values[i] << "\n";
+			else
+				out << "n/a" << "\n";
+		}
+	};
 
 	std::string filename = getUsageFilePath();
 	std::ofstream outfile(filename, std::ios::app);
@@ -288,11 +579,151 @@ void dumpUsage(rusage& startUsage, rusage& endUsage, std::chrono::time_point<std
 		outfile << "Wall Time (μs): " << wallTime << "\n";
 		outfile << "User Time (μs): " << userTime << "\n";
 		outfile << "System Time (μs): " << systemTime << "\n";
+		outfile << "Max RSS (KB): " << maxRss << "\n";
+		outfile << "Voluntary Context Switches: " << voluntarySwitches << "\n";
+		outfile << "Involuntary Context Switches: " << involuntarySwitches << "\n";
 		outfile << "======================" << "\n\n";
+
+		outfile << "=== Perf Counters ===" << "\n";
+		writePerf(outfile, runSample);
+		outfile << "=====================" << "\n\n";
+
+		auto poolStats = tp->getStats();
+		outfile << "=== Thread Pool ===" << "\n";
+		outfile << "Workers: " << poolStats.workers << "\n";
+		outfile << "Peak Workers: " << poolStats.peakWorkers << "\n";
+		outfile << "Grows: " << poolStats.grows << "\n";
+		outfile << "Shrinks: " << poolStats.shrinks << "\n";
+		outfile << "Utilization: " << poolStats.utilization << "\n";
+		for (const auto& event : poolStats.events)
+		{
+			outfile << "Resize at " << std::chrono::duration_cast<std::chrono::milliseconds>(event.at).count() << " ms: " << event.workers << " workers" << "\n";
+		}
+		outfile << "===================" << "\n\n";
+
+		if (memorySnapshot)
+		{
+			const auto& memory = *memorySnapshot;
+			outfile << "=== Memory Accounting ===" << "\n";
+			outfile << "Live Frames: " << memory.liveFrames << "\n";
+			outfile << "Peak Live Frames: " << memory.peakLiveFrames << "\n";
+			outfile << "Total Frames: " << memory.totalFrames << "\n";
+			outfile << "Frame Bytes: " << memory.frameBytes << "\n";
+			outfile << "Peak Frame Bytes: " << memory.peakFrameBytes << "\n";
+			for (size_t i = 0; i < cs::memoryAccounting::frameSizeClasses; ++i)
+			{
+				if (memory.liveFramesBySize[i] == 0)
+					continue;
+				size_t limit = cs::memoryAccounting::sizeClassLimit(i);
+				outfile << "Frames " << (limit == 0 ? "> " + std::to_string(cs::memoryAccounting::sizeClassLimit(i - 1)) : "<= " + std::to_string(limit))
+						<< " B: " << memory.liveFramesBySize[i] << " (" << memory.frameBytesBySize[i] << " B)" << "\n";
+			}
+			outfile << "Queue Blocks: " << memory.queueBlocks << "\n";
+			outfile << "Queue Bytes: " << memory.queueBytes << "\n";
+			outfile << "Peak Queue Bytes: " << memory.peakQueueBytes << "\n";
+			outfile << "=========================" << "\n\n";
+		}
+
+		for (size_t i = 0; i < workerPerf.size(); ++i)
+		{
+			outfile << "=== Worker " << i << " Perf Counters ===" << "\n";
+			writePerf(outfile, workerPerf[i]);
+			outfile << "=====================" << "\n\n";
+		}
 		outfile.close();
 	}
 	else
 	{
 		spdlog::error("Failed to open file {} for writing!", filename);
 	}
-}
\ No newline at end of file
+}
+
+cs::workload::config getWorkloadConfig()
+{
+	cs::workload::config config;
+	config.csSpin = std::chrono::nanoseconds(csSpinNsOption);
+	config.csLines = csLinesOption;
+	config.csSleep = std::chrono::microseconds(csSleepUsOption);
+	config.thinkSpin = std::chrono::nanoseconds(thinkNsOption);
+	config.longRatio = csLongRatioOption;
+	config.longCsSpin = std::chrono::nanoseconds(csLongSpinNsOption);
+	return config;
+}
+
+int runOpenLoop()
+{
+	cs::openLoopRunner::config config { threadsNumberOption, sharedNumberOption, targetOption, cs::openLoopRunner::arrival::constant, openRatesOption,
+		openRateStartOption, std::chrono::milliseconds(warmupTimeOption), std::chrono::milliseconds(trialTimeOption), maxInFlightOption, getWorkloadConfig(),
+		blockingThreadsOption, lockAffinityOption, lockStripesOption };
+
+	try
+	{
+		config.arrivals = cs::openLoopRunner::parseArrival(openLoopOption);
+		cs::openLoopRunner runner(config);
+		runner.run();
+		runner.dumpJson(getOpenLoopJsonFilePath());
+		runner.dumpCsv(getOpenLoopCsvFilePath());
+	}
+	catch (const std::exception& e)
+	{
+		spdlog::error("Open loop failed: {}", e.what());
+		return 1;
+	}
+
+	spdlog::info("Open-loop results written to {} and {}", getOpenLoopJsonFilePath(), getOpenLoopCsvFilePath());
+	spdlog::shutdown();
+	return 0;
+}
+
+void writeSummary()
+{
+	std::vector<cs::counterDumper::total> totals;
+	if (!cs::counterDumper::readTotals(getCounterDumpFilePath(), totals))
+		return;
+
+	cs::steadyState::config config { std::chrono::milliseconds(warmupDiscardOption), steadyWindowOption, steadyCvOption };
+	cs::steadyState::write(getSummaryFilePath(), config, cs::steadyState::analyze(totals, config));
+}
+
+int runSweep()
+{
+	cs::sweepRunner::config config { sweepThreadsOption, sweepCoroOption, sweepSharedOption, sweepTargetsOption, std::chrono::milliseconds(warmupTimeOption),
+		std::chrono::milliseconds(trialTimeOption), trialsOption, counterShardsOption, getWorkloadConfig(), cs::coroMode::respawn, blockingThreadsOption,
+		lockAffinityOption, lockStripesOption };
+
+	try
+	{
+		config.mode = cs::parseCoroMode(coroModeOption);
+	}
+	catch (const std::exception& e)
+	{
+		spdlog::error("{}", e.what());
+		return 1;
+	}
+
+	for (const auto& target : sweepTargetsOption)
+	{
+		if (!cs::syncTargets::isKnown(target))
+		{
+			spdlog::error("Unknown sweep target: {}", target);
+			return 1;
+		}
+	}
+
+	try
+	{
+		cs::sweepRunner runner(config);
+		runner.run();
+		runner.dumpJson(getSweepJsonFilePath());
+		runner.dumpCsv(getSweepCsvFilePath());
+	}
+	catch (const std::exception& e)
+	{
+		spdlog::error("Sweep failed: {}", e.what());
+		return 1;
+	}
+
+	spdlog::info("Sweep results written to {} and {}", getSweepJsonFilePath(), getSweepCsvFilePath());
+	spdlog::shutdown();
+	return 0;
+}
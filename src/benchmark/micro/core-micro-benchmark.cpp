@@ -0,0 +1,554 @@
+// Fixed costs of src/core primitives, measured in isolation with Google Benchmark.
+// The benchmark thread is pinned to CPU 0 and pool workers to the following CPUs (modulo the CPUs count),
+// so handoff numbers do not depend on where the scheduler happens to put the threads.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <coroutine>
+#include <cstdint>
+#include <execution>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <benchmark/benchmark.h>
+
+#include "benchmark/locks/spin-backoff.h"
+
+#include "core/async-generator.h"
+#include "core/blocking-pool.h"
+#include "core/coro-mutex.h"
+#include "core/memory-accounting.h"
+#include "core/offload-blocking.h"
+#include "core/parallel.h"
+#include "core/task-manager.h"
+#include "core/task.h"
+#include "core/thread-pool.h"
+
+namespace
+{
+
+void pinCurrentThread(size_t cpu)
+{
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu % std::thread::hardware_concurrency(), &set);
+	pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+// Starts a pool whose worker i is pinned to CPU i + 1 and routes taskManager to it
+std::shared_ptr<cs::threadPool> startPinnedPool(size_t workers, bool localPush = true)
+{
+	auto tp = std::make_shared<cs::threadPool>(workers);
+	tp->setLocalPush(localPush);
+	tp->setWorkerHooks([](size_t idx) { pinCurrentThread(idx + 1); }, nullptr);
+	cs::taskManager::instance().init(tp);
+	tp->start();
+	return tp;
+}
+
+// Suspends without rescheduling, optionally reporting that the frame is suspended
+struct park
+{
+	std::atomic<bool>* parked { nullptr };
+
+	bool await_ready() noexcept { return false; }
+	void await_suspend(std::coroutine_handle<>) noexcept
+	{
+		if (parked)
+			parked->store(true, std::memory_order_release);
+	}
+	void await_resume() noexcept { }
+};
+
+cs::task parkLoop(std::atomic<bool>* parked)
+{
+	while (true)
+		co_await park { parked };
+}
+
+cs::task lockLoop(cs::coroMutex& mtx, benchmark::State& state)
+{
+	for (auto _ : state)
+	{
+		co_await mtx.lock();
+		mtx.unlock();
+	}
+}
+
+cs::task handoffLoop(cs::coroMutex& mtx, size_t iterations, int64_t& shared, std::atomic<size_t>& finished)
+{
+	for (size_t i = 0; i < iterations; ++i)
+	{
+		co_await mtx.lock();
+		++shared;
+		mtx.unlock();
+		co_await cs::yield();
+	}
+	finished.fetch_add(1, std::memory_order_release);
+}
+
+// Increments every counter of data under mtx, with delegate - through co_await mtx.run()
+cs::task combiningLoop(cs::coroMutex& mtx, bool delegate, size_t iterations, std::vector<int64_t>& data, std::atomic<size_t>& finished)
+{
+	auto section = [&data]()
+	{
+		for (auto& value : data)
+			++value;
+	};
+	for (size_t i = 0; i < iterations; ++i)
+	{
+		if (delegate)
+		{
+			co_await mtx.run(section);
+		}
+		else
+		{
+			co_await mtx.lock();
+			section();
+			mtx.unlock();
+		}
+		co_await cs::yield();
+	}
+	finished.fetch_add(1, std::memory_order_release);
+}
+
+cs::task waitOn(cs::coroMutex& mtx)
+{
+	co_await mtx.lock();
+	mtx.unlock();
+}
+
+cs::task yieldLoop(size_t yields, std::atomic<size_t>& finished)
+{
+	for (size_t i = 0; i < yields; ++i)
+		co_await cs::yield();
+	finished.fetch_add(1, std::memory_order_release);
+}
+
+// Sleeps in a loop until stop, on its worker or on the blocking pool
+cs::task blockingLoop(bool offload, std::atomic<bool>& stop, std::atomic<size_t>& finished)
+{
+	auto call = []() { std::this_thread::sleep_for(std::chrono::microseconds(500)); };
+	while (!stop.load(std::memory_order_relaxed))
+	{
+		if (offload)
+			co_await cs::offload_blocking(call);
+		else
+			call();
+		co_await cs::yield();
+	}
+	finished.fetch_add(1, std::memory_order_release);
+}
+
+// Each step reads and writes the chain's working set and spawns the next step from the worker it runs on
+cs::task chainStep(std::vector<int64_t>& data, size_t steps, std::atomic<size_t>& finished)
+{
+	for (auto& value : data)
+		++value;
+	if (steps > 1)
+		cs::executor::current().execute(chainStep(data, steps - 1, finished));
+	else
+		finished.fetch_add(1, std::memory_order_release);
+	co_return;
+}
+
+// Yields count elements, with locked - each one under an uncontended coroMutex
+cs::async_generator<int64_t> produce(size_t count, cs::coroMutex* locked)
+{
+	for (int64_t i = 0; i < static_cast<int64_t>(count); ++i)
+	{
+		if (locked)
+		{
+			co_await locked->lock();
+			locked->unlock();
+		}
+		co_yield i;
+	}
+}
+
+cs::task consume(size_t count, cs::coroMutex* locked, int64_t& sum)
+{
+	auto gen = produce(count, locked);
+	while (int64_t* value = co_await gen.next())
+		sum += *value;
+}
+
+// Element of the parallel benchmarks, a few flops so that the loops are not purely memory bound
+inline double transform(double x)
+{
+	return std::sqrt(x * x + 1.0);
+}
+
+cs::task parallelForRoot(std::vector<double>& data, size_t grain, std::atomic<bool>& finished)
+{
+	co_await cs::parallel_for(size_t { 0 }, data.size(), grain, [&data](size_t i) { data[i] = transform(data[i]); });
+	finished.store(true, std::memory_order_release);
+}
+
+cs::task parallelReduceRoot(const std::vector<double>& data, size_t grain, double& result, std::atomic<bool>& finished)
+{
+	result = co_await cs::parallel_reduce(size_t { 0 }, data.size(), grain, 0.0, [&data](size_t i) { return transform(data[i]); }, std::plus<> {});
+	finished.store(true, std::memory_order_release);
+}
+
+constexpr size_t parallelSize = 1 << 24;
+
+// co_await cs::parallel_for over 16M doubles on a pool with a worker per CPU, arg - grain (0 - adaptive)
+void BM_ParallelFor(benchmark::State& state)
+{
+	pinCurrentThread(0);
+	auto tp = startPinnedPool(std::thread::hardware_concurrency());
+	std::vector<double> data(parallelSize, 1.0);
+
+	for (auto _ : state)
+	{
+		std::atomic<bool> finished { false };
+		cs::taskManager::instance().execute(parallelForRoot(data, static_cast<size_t>(state.range(0)), finished));
+		cs::spinBackoff backoff;
+		while (!finished.load(std::memory_order_acquire))
+			backoff.pause();
+	}
+
+	tp->stop();
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * parallelSize));
+}
+BENCHMARK(BM_ParallelFor)->Arg(0)->Arg(4096)->Arg(65536)->UseRealTime();
+
+// Baseline for BM_ParallelFor: std::for_each(std::execution::par) on the same array
+void BM_ParallelForStdPar(benchmark::State& state)
+{
+	std::vector<double> data(parallelSize, 1.0);
+
+	for (auto _ : state)
+		std::for_each(std::execution::par, data.begin(), data.end(), [](double& x) { x = transform(x); });
+
+	benchmark::DoNotOptimize(data.data());
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * parallelSize));
+}
+BENCHMARK(BM_ParallelForStdPar)->UseRealTime();
+
+// co_await cs::parallel_reduce summing transform() of 16M doubles, arg - grain (0 - adaptive)
+void BM_ParallelReduce(benchmark::State& state)
+{
+	pinCurrentThread(0);
+	auto tp = startPinnedPool(std::thread::hardware_concurrency());
+	std::vector<double> data(parallelSize, 1.0);
+	double result = 0.0;
+
+	for (auto _ : state)
+	{
+		std::atomic<bool> finished { false };
+		cs::taskManager::instance().execute(parallelReduceRoot(data, static_cast<size_t>(state.range(0)), result, finished));
+		cs::spinBackoff backoff;
+		while (!finished.load(std::memory_order_acquire))
+			backoff.pause();
+	}
+
+	tp->stop();
+	benchmark::DoNotOptimize(result);
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * parallelSize));
+}
+BENCHMARK(BM_ParallelReduce)->Arg(0)->Arg(4096)->Arg(65536)->UseRealTime();
+
+// Baseline for BM_ParallelReduce: std::transform_reduce(std::execution::par)
+void BM_ParallelReduceStdPar(benchmark::State& state)
+{
+	std::vector<double> data(parallelSize, 1.0);
+	double result = 0.0;
+
+	for (auto _ : state)
+		result = std::transform_reduce(std::execution::par, data.begin(), data.end(), 0.0, std::plus<> {}, transform);
+
+	benchmark::DoNotOptimize(result);
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * parallelSize));
+}
+BENCHMARK(BM_ParallelReduceStdPar)->UseRealTime();
+
+// Elements per second pulled through an async_generator by a consumer coroutine, both on the benchmark thread,
+// arg 0 - plain co_yield, arg 1 - the producer also co_awaits an uncontended coroMutex per element
+void BM_AsyncGenerator(benchmark::State& state)
+{
+	constexpr size_t batch = 1024;
+
+	pinCurrentThread(0);
+	cs::coroMutex mtx;
+	cs::coroMutex* locked = state.range(0) != 0 ? &mtx : nullptr;
+	int64_t sum = 0;
+
+	for (auto _ : state)
+	{
+		auto t = consume(batch, locked, sum);
+		t.resume();
+		t.handle().destroy();
+	}
+
+	benchmark::DoNotOptimize(sum);
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * batch));
+}
+BENCHMARK(BM_AsyncGenerator)->Arg(0)->Arg(1);
+
+// Memory of arg coroutines suspended on one held coroMutex, as reported by memoryAccounting:
+// frame bytes and waiter queue bytes per suspended coroutine
+void BM_SuspendedFrames(benchmark::State& state)
+{
+	if (!cs::memoryAccounting::compiled)
+	{
+		state.SkipWithError("built without BUILD_MEMORY_ACCOUNTING");
+		return;
+	}
+
+	const size_t coros = static_cast<size_t>(state.range(0));
+	cs::memoryAccounting::enable(true);
+
+	for (auto _ : state)
+	{
+		auto before = cs::memoryAccounting::take();
+		auto mtx = std::make_unique<cs::coroMutex>();
+		mtx->lock();
+
+		std::vector<std::coroutine_handle<>> handles;
+		handles.reserve(coros);
+		for (size_t i = 0; i < coros; ++i)
+		{
+			auto t = waitOn(*mtx);
+			t.resume();
+			handles.push_back(t.handle());
+		}
+
+		auto during = cs::memoryAccounting::take();
+		double frameBytes = static_cast<double>(during.frameBytes - before.frameBytes);
+		double queueBytes = static_cast<double>(during.queueBytes - before.queueBytes);
+		state.counters["frame_bytes_per_coro"] = frameBytes / static_cast<double>(coros);
+		state.counters["queue_bytes_per_coro"] = queueBytes / static_cast<double>(coros);
+		state.counters["total_mib"] = (frameBytes + queueBytes) / (1024.0 * 1024.0);
+
+		// Never resumed: drop the waiters together with the mutex
+		mtx.reset();
+		for (auto handle : handles)
+			handle.destroy();
+	}
+
+	cs::memoryAccounting::enable(false);
+}
+BENCHMARK(BM_SuspendedFrames)->Arg(1 << 20)->Iterations(1)->Unit(benchmark::kMillisecond);
+
+// Uncontended co_await lock() + unlock(), the whole loop runs inside one coroutine
+void BM_CoroMutexUncontended(benchmark::State& state)
+{
+	pinCurrentThread(0);
+	cs::coroMutex mtx;
+	auto t = lockLoop(mtx, state);
+	t.resume();
+	t.handle().destroy();
+}
+BENCHMARK(BM_CoroMutexUncontended);
+
+// Two coroutines on two workers alternating on one coroMutex, every unlock with a waiter hands the lock
+// over through the pool. Time per item is the cost of one acquisition under contention.
+void BM_CoroMutexHandoff(benchmark::State& state)
+{
+	constexpr size_t batch = 1000;
+
+	pinCurrentThread(0);
+	auto tp = startPinnedPool(2);
+	cs::coroMutex mtx;
+	int64_t shared = 0;
+
+	for (auto _ : state)
+	{
+		std::atomic<size_t> finished { 0 };
+		cs::taskManager::instance().execute(handoffLoop(mtx, batch / 2, shared, finished));
+		cs::taskManager::instance().execute(handoffLoop(mtx, batch / 2, shared, finished));
+		cs::spinBackoff backoff;
+		while (finished.load(std::memory_order_acquire) != 2)
+			backoff.pause();
+	}
+
+	tp->stop();
+	benchmark::DoNotOptimize(shared);
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * batch));
+}
+BENCHMARK(BM_CoroMutexHandoff)->UseRealTime();
+
+// 16 coroutines on 4 workers incrementing a 512-byte counter array under one coroMutex, arg 0 - lock()/unlock(),
+// arg 1 - co_await run(): a contended caller publishes the increment and the holder runs it, so the array stays
+// in the holder's cache. Time per item is one critical section.
+void BM_CoroMutexCombining(benchmark::State& state)
+{
+	constexpr size_t batch = 4096;
+	constexpr size_t coros = 16;
+	const bool delegate = state.range(0) != 0;
+
+	pinCurrentThread(0);
+	auto tp = startPinnedPool(4);
+	cs::coroMutex mtx;
+	std::vector<int64_t> data(64);
+
+	for (auto _ : state)
+	{
+		std::atomic<size_t> finished { 0 };
+		for (size_t i = 0; i < coros; ++i)
+			cs::taskManager::instance().execute(combiningLoop(mtx, delegate, batch / coros, data, finished));
+		cs::spinBackoff backoff;
+		while (finished.load(std::memory_order_acquire) != coros)
+			backoff.pause();
+	}
+
+	tp->stop();
+	benchmark::DoNotOptimize(data.data());
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * batch));
+}
+BENCHMARK(BM_CoroMutexCombining)->Arg(0)->Arg(1)->UseRealTime();
+
+// Spawn chains with a 16 KiB working set each, arg 0 - every spawn goes to a random worker queue,
+// arg 1 - spawns from a worker stay on it (run-next slot), so the next step finds the working set in its cache
+void BM_SpawnChain(benchmark::State& state)
+{
+	constexpr size_t chains = 8;
+	constexpr size_t steps = 256;
+	constexpr size_t chainBytes = 16 * 1024;
+
+	pinCurrentThread(0);
+	auto tp = startPinnedPool(4, state.range(0) != 0);
+	std::vector<std::vector<int64_t>> data(chains, std::vector<int64_t>(chainBytes / sizeof(int64_t)));
+
+	for (auto _ : state)
+	{
+		std::atomic<size_t> finished { 0 };
+		for (auto& chain : data)
+			cs::taskManager::instance().execute(chainStep(chain, steps, finished));
+		cs::spinBackoff backoff;
+		while (finished.load(std::memory_order_acquire) != chains)
+			backoff.pause();
+	}
+
+	tp->stop();
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * chains * steps));
+}
+BENCHMARK(BM_SpawnChain)->Arg(0)->Arg(1)->UseRealTime();
+
+// co_await cs::yield() on a single worker shared by arg coroutines, time per item is one yield
+void BM_Yield(benchmark::State& state)
+{
+	constexpr size_t batch = 1024;
+	const size_t coros = static_cast<size_t>(state.range(0));
+
+	pinCurrentThread(0);
+	auto tp = startPinnedPool(1);
+
+	for (auto _ : state)
+	{
+		std::atomic<size_t> finished { 0 };
+		for (size_t i = 0; i < coros; ++i)
+			cs::taskManager::instance().execute(yieldLoop(batch / coros, finished));
+		cs::spinBackoff backoff;
+		while (finished.load(std::memory_order_acquire) != coros)
+			backoff.pause();
+	}
+
+	tp->stop();
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * batch));
+}
+BENCHMARK(BM_Yield)->Arg(1)->Arg(8)->UseRealTime();
+
+// Yield throughput of non-blocking coroutines on a 2-worker pool that also runs 2 coroutines calling sleep_for,
+// arg 0 - the sleeps block the pool workers, arg 1 - they are offloaded to the blocking pool
+void BM_BlockingNeighbours(benchmark::State& state)
+{
+	constexpr size_t batch = 1024;
+	constexpr size_t coros = 4;
+	constexpr size_t blockers = 2;
+	const bool offload = state.range(0) != 0;
+
+	pinCurrentThread(0);
+	if (offload)
+		cs::blockingPool::instance().start(blockers);
+	auto tp = startPinnedPool(2);
+
+	std::atomic<bool> stop { false };
+	std::atomic<size_t> blockersFinished { 0 };
+	for (size_t i = 0; i < blockers; ++i)
+		cs::taskManager::instance().execute(blockingLoop(offload, stop, blockersFinished));
+
+	for (auto _ : state)
+	{
+		std::atomic<size_t> finished { 0 };
+		for (size_t i = 0; i < coros; ++i)
+			cs::taskManager::instance().execute(yieldLoop(batch / coros, finished));
+		cs::spinBackoff backoff;
+		while (finished.load(std::memory_order_acquire) != coros)
+			backoff.pause();
+	}
+
+	stop = true;
+	cs::spinBackoff backoff;
+	while (blockersFinished.load(std::memory_order_acquire) != blockers)
+		backoff.pause();
+	tp->stop();
+	cs::blockingPool::instance().stop();
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * batch));
+}
+BENCHMARK(BM_BlockingNeighbours)->Arg(0)->Arg(1)->UseRealTime();
+
+// taskManager::execute from the benchmark thread until the coroutine runs on a worker and suspends again
+void BM_ExecuteToResume(benchmark::State& state)
+{
+	pinCurrentThread(0);
+	auto tp = startPinnedPool(1);
+	std::atomic<bool> parked { false };
+	auto t = parkLoop(&parked);
+	std::coroutine_handle<> handle = t.handle();
+
+	for (auto _ : state)
+	{
+		parked.store(false, std::memory_order_relaxed);
+		cs::taskManager::instance().execute(handle);
+		cs::spinBackoff backoff;
+		while (!parked.load(std::memory_order_acquire))
+			backoff.pause();
+	}
+
+	tp->stop();
+	t.handle().destroy();
+}
+BENCHMARK(BM_ExecuteToResume)->UseRealTime();
+
+// task::resume of a suspended coroutine that immediately suspends again
+void BM_TaskResume(benchmark::State& state)
+{
+	pinCurrentThread(0);
+	auto t = parkLoop(nullptr);
+
+	for (auto _ : state)
+		benchmark::DoNotOptimize(t.resume());
+
+	t.handle().destroy();
+}
+BENCHMARK(BM_TaskResume);
+
+// Frame allocation, first resume to completion and destruction of an empty task
+void BM_TaskCreateDestroy(benchmark::State& state)
+{
+	pinCurrentThread(0);
+	auto empty = []() -> cs::task { co_return; };
+
+	for (auto _ : state)
+	{
+		auto t = empty();
+		t.resume();
+		t.handle().destroy();
+	}
+}
+BENCHMARK(BM_TaskCreateDestroy);
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,348 @@
+#include "benchmark/openloop/open-loop-runner.h"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include <spdlog/spdlog.h>
+
+#include "benchmark/counter/atomic-multiple-counter.h"
+#include "benchmark/latency/latency-recorder.h"
+#include "benchmark/locks/sync-targets.h"
+
+#include "core/blocking-pool.h"
+#include "core/offload-blocking.h"
+#include "core/task-manager.h"
+#include "core/thread-pool.h"
+
+using namespace cs;
+
+namespace
+{
+using requestClock = latencyRecorder::clock_t;
+
+struct requestContext
+{
+	atomicMultipleCounter& counter;
+	latencyRecorder& latency;
+	workload& load;
+	std::atomic<uint64_t>& inFlight;
+};
+
+// Runs under the lock, returns the acquisition and release times
+std::pair<requestClock::time_point, requestClock::time_point> criticalSection(requestContext& ctx, size_t idx)
+{
+	auto acquired = requestClock::now();
+	ctx.counter.increment(idx);
+	ctx.load.criticalSection(idx);
+	return { acquired, requestClock::now() };
+}
+
+void complete(requestContext& ctx, requestClock::time_point intended, std::pair<requestClock::time_point, requestClock::time_point> times, bool measured)
+{
+	if (measured)
+	{
+		ctx.latency.record(intended, times.first, times.second);
+		ctx.latency.recordResponse(intended, times.second);
+	}
+	ctx.inFlight.fetch_sub(1, std::memory_order_relaxed);
+}
+
+task coroMutexRequest(requestContext& ctx, coroMutex& mtx, size_t idx, requestClock::time_point intended, bool measured)
+{
+	co_await mtx.lock();
+	auto times = criticalSection(ctx, idx);
+	mtx.unlock();
+	complete(ctx, intended, times, measured);
+}
+
+task runRequest(requestContext& ctx, coroMutex& mtx, size_t idx, requestClock::time_point intended, bool measured)
+{
+	auto times = co_await mtx.run([&]() { return criticalSection(ctx, idx); });
+	complete(ctx, intended, times, measured);
+}
+
+task tableRequest(requestContext& ctx, coroLockTable& table, size_t idx, requestClock::time_point intended, bool measured)
+{
+	co_await table.lock(idx);
+	auto times = criticalSection(ctx, idx);
+	table.unlock(idx);
+	complete(ctx, intended, times, measured);
+}
+
+template<typename Lockable>
+task blockingRequest(requestContext& ctx, Lockable& mtx, size_t idx, requestClock::time_point intended, bool measured, bool offload)
+{
+	auto iteration = [&]()
+	{
+		mtx.lock();
+		auto times = criticalSection(ctx, idx);
+		mtx.unlock();
+		return times;
+	};
+
+	std::pair<requestClock::time_point, requestClock::time_point> times;
+	if (offload)
+		times = co_await offload_blocking(iteration);
+	else
+		times = iteration();
+	complete(ctx, intended, times, measured);
+}
+
+void spawn(requestContext& ctx, syncTargets& targets, size_t idx, requestClock::time_point intended, bool measured, bool offload)
+{
+	auto& manager = taskManager::instance();
+	const auto& target = targets.target;
+	if (target == "cm")
+		manager.execute(coroMutexRequest(ctx, targets.cm[idx], idx, intended, measured));
+	else if (target == "cmr")
+		manager.execute(runRequest(ctx, targets.cm[idx], idx, intended, measured));
+	else if (target == "lt")
+		manager.execute(tableRequest(ctx, *targets.lt, idx, intended, measured));
+	else if (target == "m")
+		manager.execute(blockingRequest(ctx, targets.m[idx], idx, intended, measured, offload));
+	else if (target == "ttas")
+		manager.execute(blockingRequest(ctx, targets.ttas[idx], idx, intended, measured, offload));
+	else if (target == "ticket")
+		manager.execute(blockingRequest(ctx, targets.ticket[idx], idx, intended, measured, offload));
+	else if (target == "mcs")
+		manager.execute(blockingRequest(ctx, targets.mcs[idx], idx, intended, measured, offload));
+	else if (target == "futex")
+		manager.execute(blockingRequest(ctx, targets.futex[idx], idx, intended, measured, offload));
+	else if (target == "sm")
+		manager.execute(blockingRequest(ctx, targets.sm[idx], idx, intended, measured, offload));
+}
+} // namespace
+
+openLoopRunner::arrival openLoopRunner::parseArrival(const std::string& name)
+{
+	if (name == "constant")
+		return arrival::constant;
+	if (name == "poisson")
+		return arrival::poisson;
+	throw std::runtime_error("Unknown arrival process: " + name);
+}
+
+std::string openLoopRunner::toString(arrival arrivals)
+{
+	return arrivals == arrival::poisson ? "poisson" : "constant";
+}
+
+openLoopRunner::openLoopRunner(const config& cfg)
+: config_ { cfg }
+{
+	if (config_.target == "spawn" || !syncTargets::isKnown(config_.target))
+		throw std::runtime_error("Open loop needs a lock target, got: " + config_.target);
+	config_.shared = std::max<uint64_t>(config_.shared, 1);
+}
+
+void openLoopRunner::run()
+{
+	results_.clear();
+	for (size_t step = 0;; ++step)
+	{
+		uint64_t rate;
+		if (config_.rates.empty())
+		{
+			if (step == maxSteps)
+				break;
+			rate = std::max<uint64_t>(config_.startRate, 1) << step;
+		}
+		else
+		{
+			if (step == config_.rates.size())
+				break;
+			rate = config_.rates[step];
+		}
+		if (rate == 0)
+			continue;
+
+		results_.push_back(runPoint(rate));
+		if (results_.back().saturated)
+		{
+			spdlog::info("Saturated at {} requests/s", rate);
+			break;
+		}
+	}
+}
+
+openLoopRunner::result openLoopRunner::runPoint(uint64_t rate)
+{
+	spdlog::info("Open-loop point: {} requests/s, {} arrivals", rate, toString(config_.arrivals));
+
+	atomicMultipleCounter counter(config_.shared);
+	latencyRecorder latency;
+	workload load(config_.load, config_.shared);
+	syncTargets targets(config_.target, config_.shared, config_.lockStripes);
+	targets.setLockAffinity(config_.lockAffinity, config_.threads);
+	std::atomic<uint64_t> inFlight { 0 };
+	requestContext ctx { counter, latency, load, inFlight };
+	bool offload = config_.blockingThreads != 0;
+
+	auto tp = std::make_shared<threadPool>(config_.threads);
+	taskManager::instance().init(tp);
+	if (offload)
+		blockingPool::instance().start(config_.blockingThreads);
+	tp->start();
+
+	result res {};
+	res.offeredRate = static_cast<double>(rate);
+
+	std::mt19937_64 generator(std::random_device {}());
+	std::exponential_distribution<double> poissonGap(static_cast<double>(rate) / 1e9);
+	const double constantGap = 1e9 / static_cast<double>(rate);
+
+	// Arrival times are an offset from the start, not a sum of rounded gaps, so the rate does not drift
+	auto start = requestClock::now();
+	auto measureFrom = start + config_.warmupTime;
+	auto measureTo = measureFrom + config_.trialTime;
+	double offsetNs = 0.0;
+	uint64_t issued = 0;
+	int64_t completedBefore = 0;
+	bool measuring = false;
+	requestClock::time_point windowStart;
+
+	for (size_t i = 0;; ++i)
+	{
+		offsetNs += config_.arrivals == arrival::poisson ? poissonGap(generator) : constantGap;
+		auto intended = start + std::chrono::nanoseconds(static_cast<int64_t>(offsetNs));
+		if (intended >= measureTo)
+			break;
+		// Behind schedule the request goes out right away, its latency still counts from the intended start
+		if (intended > requestClock::now())
+			std::this_thread::sleep_until(intended);
+
+		bool measured = intended >= measureFrom;
+		if (measured && !measuring)
+		{
+			measuring = true;
+			windowStart = requestClock::now();
+			completedBefore = counter.get_total();
+		}
+
+		inFlight.fetch_add(1, std::memory_order_relaxed);
+		spawn(ctx, targets, i % config_.shared, intended, measured, offload);
+		if (measured)
+			++issued;
+
+		if (inFlight.load(std::memory_order_relaxed) > config_.maxInFlight)
+		{
+			spdlog::warn("  more than {} requests in flight, stopping the point", config_.maxInFlight);
+			res.saturated = true;
+			break;
+		}
+	}
+
+	if (measuring)
+	{
+		double seconds = std::chrono::duration<double>(requestClock::now() - windowStart).count();
+		int64_t completedAfter = counter.get_total();
+		if (seconds > 0.0)
+		{
+			res.issuedRate = static_cast<double>(issued) / seconds;
+			res.completedRate = static_cast<double>(completedAfter - completedBefore) / seconds;
+		}
+	}
+
+	// A pool keeping up finishes what is queued well within a trial
+	auto drainUntil = requestClock::now() + config_.trialTime;
+	while (inFlight.load() != 0 && requestClock::now() < drainUntil)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	if (inFlight.load() != 0 || res.completedRate < 0.9 * res.issuedRate || !measuring)
+		res.saturated = true;
+
+	// The backlog of a saturated point still holds suspended frames, the pools keep running until it is gone
+	if (inFlight.load() != 0)
+		spdlog::info("  draining {} requests in flight", inFlight.load());
+	while (inFlight.load() != 0)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	// Offloaded calls still in flight resume their coroutines on tp
+	blockingPool::instance().stop();
+	tp->stop();
+
+	auto response = latency.mergedResponse();
+	auto wait = latency.mergedWait();
+	res.requests = response.count();
+	res.responseP50 = response.percentile(50);
+	res.responseP90 = response.percentile(90);
+	res.responseP99 = response.percentile(99);
+	res.responseP999 = response.percentile(99.9);
+	res.responseMax = response.max();
+	res.waitP50 = wait.percentile(50);
+	res.waitP99 = wait.percentile(99);
+
+	spdlog::info("  issued {:.1f}/s, completed {:.1f}/s, response p50/p99/p999/max {}/{}/{}/{} ns{}", res.issuedRate, res.completedRate, res.responseP50,
+		res.responseP99, res.responseP999, res.responseMax, res.saturated ? ", saturated" : "");
+	return res;
+}
+
+const std::vector<openLoopRunner::result>& openLoopRunner::results() const
+{
+	return results_;
+}
+
+bool openLoopRunner::dumpJson(const std::string& filename) const
+{
+	std::ofstream out(filename, std::ios_base::trunc);
+	if (!out.is_open())
+	{
+		spdlog::error("Failed to open file {} for writing!", filename);
+		return false;
+	}
+
+	out << "{\n";
+	out << "  \"threads\": " << config_.threads << ",\n";
+	out << "  \"shared\": " << config_.shared << ",\n";
+	out << "  \"target\": \"" << config_.target << "\",\n";
+	out << "  \"arrivals\": \"" << toString(config_.arrivals) << "\",\n";
+	out << "  \"warmup_ms\": " << config_.warmupTime.count() << ",\n";
+	out << "  \"trial_ms\": " << config_.trialTime.count() << ",\n";
+	out << "  \"max_in_flight\": " << config_.maxInFlight << ",\n";
+	out << "  \"blocking_threads\": " << config_.blockingThreads << ",\n";
+	out << "  \"lock_affinity\": \"" << config_.lockAffinity << "\",\n";
+	out << "  \"lock_stripes\": " << config_.lockStripes << ",\n";
+	out << "  \"results\": [\n";
+	for (size_t i = 0; i < results_.size(); ++i)
+	{
+		const auto& res = results_[i];
+		out << "    { \"offered_rate\": " << res.offeredRate << ", \"issued_rate\": " << res.issuedRate << ", \"completed_rate\": " << res.completedRate
+				<< ", \"requests\": " << res.requests;
+		out << ", \"response_p50_ns\": " << res.responseP50 << ", \"response_p90_ns\": " << res.responseP90 << ", \"response_p99_ns\": " << res.responseP99
+				<< ", \"response_p999_ns\": " << res.responseP999 << ", \"response_max_ns\": " << res.responseMax;
+		out << ", \"wait_p50_ns\": " << res.waitP50 << ", \"wait_p99_ns\": " << res.waitP99 << ", \"saturated\": " << (res.saturated ? "true" : "false") << " }"
+				<< (i + 1 == results_.size() ? "" : ",") << "\n";
+	}
+	out << "  ]\n";
+	out << "}\n";
+	return true;
+}
+
+bool openLoopRunner::dumpCsv(const std::string& filename) const
+{
+	std::ofstream out(filename, std::ios_base::trunc);
+	if (!out.is_open())
+	{
+		spdlog::error("Failed to open file {} for writing!", filename);
+		return false;
+	}
+
+	out << "offered_rate,issued_rate,completed_rate,requests,response_p50_ns,response_p90_ns,response_p99_ns,response_p999_ns,response_max_ns,wait_p50_ns,"
+				 "wait_p99_ns,saturated\n";
+	for (const auto& res : results_)
+	{
+		out << res.offeredRate << "," << res.issuedRate << "," << res.completedRate << "," << res.requests << "," << res.responseP50 << "," << res.responseP90 << ","
+				<< res.responseP99 << "," << res.responseP999 << "," << res.responseMax << "," << res.waitP50 << "," << res.waitP99 << "," << (res.saturated ? 1 : 0)
+				<< "\n";
+	}
+	return true;
+}
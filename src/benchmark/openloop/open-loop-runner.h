@@ -0,0 +1,85 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "benchmark/workload/workload.h"
+
+namespace cs
+{
+
+// Open-loop load: for every offered rate a fresh pool and primitives, the calling thread generates arrivals on a
+// schedule (constant gaps or Poisson) and spawns one coroutine per request, which takes the lock of shared object
+// request % shared once. Latencies are measured from the intended start of the request, so a late generator or a
+// backed up pool is charged to the request instead of silently lowering the load (no coordinated omission).
+// The rates are swept up to the first saturated point: completions falling behind arrivals, requests in flight
+// exceeding maxInFlight, or a backlog left after the drain.
+class openLoopRunner
+{
+public:
+	enum class arrival
+	{
+		constant,
+		poisson
+	};
+
+	struct config
+	{
+		uint64_t threads;
+		uint64_t shared;
+		std::string target;
+		arrival arrivals;
+		std::vector<uint64_t> rates; // requests per second; empty - doubling from startRate
+		uint64_t startRate;
+		std::chrono::milliseconds warmupTime;
+		std::chrono::milliseconds trialTime;
+		size_t maxInFlight;
+		workload::config load;
+		size_t blockingThreads; // 0 - blocking targets run on the pool workers
+		std::string lockAffinity; // syncTargets::setLockAffinity mode
+		size_t lockStripes;       // lt target
+	};
+
+	struct result
+	{
+		double offeredRate;   // configured, requests per second
+		double issuedRate;    // actually generated in the measurement window
+		double completedRate; // lock acquisitions in the measurement window
+		uint64_t requests;    // measured
+		// Intended start -> release
+		uint64_t responseP50;
+		uint64_t responseP90;
+		uint64_t responseP99;
+		uint64_t responseP999;
+		uint64_t responseMax;
+		// Intended start -> acquisition
+		uint64_t waitP50;
+		uint64_t waitP99;
+		bool saturated;
+	};
+
+	// Doubling sweep without explicit rates stops here even if never saturated
+	static constexpr size_t maxSteps = 24;
+
+	// Throws std::runtime_error on an unknown arrival name
+	static arrival parseArrival(const std::string& name);
+	static std::string toString(arrival arrivals);
+
+	explicit openLoopRunner(const config& cfg);
+
+	void run();
+
+	const std::vector<result>& results() const;
+	bool dumpJson(const std::string& filename) const;
+	bool dumpCsv(const std::string& filename) const;
+
+private:
+	result runPoint(uint64_t rate);
+
+	config config_;
+	std::vector<result> results_;
+};
+
+} // namespace cs
@@ -1,6 +1,7 @@
 #include "benchmark/optionsManager/options-manager.h"
 
 #include <algorithm>
+#include <sstream>
 #include <stdexcept>
 #include <string>
 #include <limits>
@@ -148,6 +149,58 @@ std::string optionsManager::getString(const std::string& name, const std::string
 	return parser.getValue(name);
 }
 
+std::vector<uint64_t> optionsManager::getUInt64List(const std::string& name, const std::vector<uint64_t>& defaultValue) const
+{
+	if (!parser.isSet(name))
+	{
+		return defaultValue;
+	}
+
+	std::vector<uint64_t> values;
+	for (const auto& item : getStringList(name))
+	{
+		try
+		{
+			size_t pos = 0;
+			unsigned long long value = std::stoull(item, &pos);
+			if (pos != item.length())
+			{
+				throw std::invalid_argument("Invalid characters in number");
+			}
+			values.push_back(static_cast<uint64_t>(value));
+		}
+		catch (const std::exception& e)
+		{
+			throw std::runtime_error("Invalid uint64_t list value for option " + name + ": " + item + " (" + e.what() + ")");
+		}
+	}
+	return values;
+}
+
+std::vector<std::string> optionsManager::getStringList(const std::string& name, const std::vector<std::string>& defaultValue) const
+{
+	if (!parser.isSet(name))
+	{
+		return defaultValue;
+	}
+
+	std::vector<std::string> values;
+	std::istringstream stream(parser.getValue(name));
+	std::string item;
+	while (std::getline(stream, item, ','))
+	{
+		if (!item.empty())
+		{
+			values.push_back(item);
+		}
+	}
+	if (values.empty())
+	{
+		throw std::runtime_error("Empty list value for option " + name);
+	}
+	return values;
+}
+
 const std::vector<std::string>& optionsManager::getPositionalArgs() const
 {
 	return parser.getPositionalArgs();
@@ -29,6 +29,10 @@ public:
     double getDouble(const std::string& name, double defaultValue = 0.0) const;
     std::string getString(const std::string& name, const std::string& defaultValue = "") const;
 
+    // Comma separated lists, e.g. "1,2,4"
+    std::vector<uint64_t> getUInt64List(const std::string& name, const std::vector<uint64_t>& defaultValue = {}) const;
+    std::vector<std::string> getStringList(const std::string& name, const std::vector<std::string>& defaultValue = {}) const;
+
     const std::vector<std::string>& getPositionalArgs() const;
     bool isSet(const std::string& name) const;
 
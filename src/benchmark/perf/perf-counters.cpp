@@ -0,0 +1,149 @@
+#include "benchmark/perf/perf-counters.h"
+
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace cs;
+
+namespace
+{
+struct eventDescription
+{
+	uint32_t type;
+	uint64_t config;
+	bool hardware;
+};
+
+// clang-format off
+constexpr eventDescription events[perfCounters::eventsCount] = {
+	{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, true },
+	{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, true },
+	{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, true },
+	{ PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16), true },
+	{ PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, false },
+	{ PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS, false },
+};
+// clang-format on
+
+int openEvent(const eventDescription& description, bool inherit, int groupFd)
+{
+	perf_event_attr attr;
+	std::memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = description.type;
+	attr.config = description.config;
+	attr.disabled = groupFd == -1 ? 1 : 0;
+	attr.inherit = inherit ? 1 : 0;
+	attr.exclude_hv = 1;
+	attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+	int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0));
+	if (fd == -1 && (errno == EACCES || errno == EPERM))
+	{
+		// perf_event_paranoid >= 2 only allows user space counting
+		attr.exclude_kernel = 1;
+		fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0));
+	}
+	return fd;
+}
+} // namespace
+
+perfCounters::sample& perfCounters::sample::operator+= (const sample& other)
+{
+	for (size_t i = 0; i < eventsCount; ++i)
+	{
+		values[i] += other.values[i];
+		valid[i] = valid[i] || other.valid[i];
+	}
+	return *this;
+}
+
+const char* perfCounters::name(event e)
+{
+	switch (e)
+	{
+		case cycles: return "Cycles";
+		case instructions: return "Instructions";
+		case cacheMisses: return "Cache Misses";
+		case llcMisses: return "LLC Load Misses";
+		case contextSwitches: return "Context Switches";
+		case cpuMigrations: return "CPU Migrations";
+		default: return "Unknown";
+	}
+}
+
+perfCounters::perfCounters(bool inherit)
+{
+	fds_.fill(-1);
+
+	int leader = openEvent(events[cycles], inherit, -1);
+	fds_[cycles] = leader;
+	for (size_t i = 0; i < eventsCount; ++i)
+	{
+		if (i == cycles)
+			continue;
+		if (events[i].hardware)
+			fds_[i] = leader == -1 ? -1 : openEvent(events[i], inherit, leader);
+		else
+			fds_[i] = openEvent(events[i], inherit, -1);
+	}
+}
+
+perfCounters::~perfCounters()
+{
+	for (int fd : fds_)
+	{
+		if (fd != -1)
+			close(fd);
+	}
+}
+
+bool perfCounters::available() const
+{
+	for (int fd : fds_)
+	{
+		if (fd != -1)
+			return true;
+	}
+	return false;
+}
+
+void perfCounters::start()
+{
+	for (size_t i = 0; i < eventsCount; ++i)
+	{
+		// Group members follow their leader
+		if (fds_[i] == -1 || (events[i].hardware && i != cycles))
+			continue;
+		ioctl(fds_[i], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+		ioctl(fds_[i], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+	}
+}
+
+perfCounters::sample perfCounters::stop()
+{
+	sample result;
+	for (size_t i = 0; i < eventsCount; ++i)
+	{
+		if (fds_[i] == -1 || (events[i].hardware && i != cycles))
+			continue;
+		ioctl(fds_[i], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+	}
+
+	for (size_t i = 0; i < eventsCount; ++i)
+	{
+		uint64_t data[3] = {};
+		if (fds_[i] == -1 || read(fds_[i], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)) || data[2] == 0)
+			continue;
+
+		// Scale up if the event was multiplexed with others
+		double scale = static_cast<double>(data[1]) / static_cast<double>(data[2]);
+		result.values[i] = static_cast<uint64_t>(static_cast<double>(data[0]) * scale);
+		result.valid[i] = true;
+	}
+	return result;
+}
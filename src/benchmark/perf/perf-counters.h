@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace cs
+{
+
+// Hardware and software counters of the calling thread (or, with inherit, of the calling thread
+// and every thread it creates afterwards) via perf_event_open. Hardware events are opened as one
+// group so they are scheduled together; events the kernel refuses (no PMU in a VM, perf_event_paranoid, ...)
+// are reported as invalid instead of failing the run.
+class perfCounters
+{
+public:
+	enum event
+	{
+		cycles,
+		instructions,
+		cacheMisses,
+		llcMisses,
+		contextSwitches,
+		cpuMigrations,
+		eventsCount
+	};
+
+	struct sample
+	{
+		std::array<uint64_t, eventsCount> values {};
+		std::array<bool, eventsCount> valid {};
+
+		sample& operator+= (const sample& other);
+	};
+
+	static const char* name(event e);
+
+	explicit perfCounters(bool inherit = false);
+	~perfCounters();
+
+	perfCounters(const perfCounters&) = delete;
+	perfCounters& operator= (const perfCounters&) = delete;
+
+	bool available() const;
+
+	void start();
+	sample stop();
+
+private:
+	std::array<int, eventsCount> fds_;
+};
+
+} // namespace cs
@@ -0,0 +1,129 @@
+#include "benchmark/stats/steady-state.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <numeric>
+
+#include <spdlog/spdlog.h>
+
+using namespace cs;
+
+namespace
+{
+struct moments
+{
+	double mean;
+	double stddev;
+};
+
+moments measure(std::vector<double>::const_iterator begin, std::vector<double>::const_iterator end)
+{
+	auto n = static_cast<double>(std::distance(begin, end));
+	if (n == 0.0)
+		return { 0.0, 0.0 };
+	double mean = std::accumulate(begin, end, 0.0) / n;
+	double squares = 0.0;
+	for (auto it = begin; it != end; ++it)
+	{
+		squares += (*it - mean) * (*it - mean);
+	}
+	return { mean, n > 1.0 ? std::sqrt(squares / (n - 1.0)) : 0.0 };
+}
+
+double variation(const moments& m)
+{
+	return m.mean == 0.0 ? 0.0 : m.stddev / m.mean;
+}
+} // namespace
+
+steadyState::result steadyState::analyze(const std::vector<counterDumper::total>& totals, const config& cfg)
+{
+	// Throughput of every interval after the warm-up, the counters start at zero with the dumper.
+	// The last sample is taken by stop(), its interval is mostly spent shutting down
+	std::vector<double> throughput;
+	std::vector<std::chrono::nanoseconds> starts;
+	counterDumper::total previous { std::chrono::nanoseconds(0), 0 };
+	for (size_t i = 0; i + 1 < totals.size(); ++i)
+	{
+		const auto& current = totals[i];
+		auto length = current.elapsed - previous.elapsed;
+		// A late tick leaves a longer interval, only empty ones are skipped
+		if (length.count() > 0 && previous.elapsed >= cfg.warmup)
+		{
+			throughput.push_back(static_cast<double>(current.value - previous.value) / std::chrono::duration<double>(length).count());
+			starts.push_back(previous.elapsed);
+		}
+		previous = current;
+	}
+
+	result res {};
+	res.intervals = throughput.size();
+	if (throughput.empty())
+		return res;
+
+	size_t window = std::max<size_t>(cfg.window, 2);
+	size_t from = 0;
+	res.steady = false;
+	for (size_t i = 0; i + window <= throughput.size(); ++i)
+	{
+		if (variation(measure(throughput.begin() + i, throughput.begin() + i + window)) <= cfg.maxCv)
+		{
+			res.steady = true;
+			from = i;
+			break;
+		}
+	}
+
+	auto begin = throughput.begin() + from;
+	auto m = measure(begin, throughput.end());
+	res.steadyFromMs = std::chrono::duration<double, std::milli>(starts[from]).count();
+	res.steadyIntervals = throughput.size() - from;
+	res.mean = m.mean;
+	res.stddev = m.stddev;
+	res.min = *std::min_element(begin, throughput.end());
+	res.max = *std::max_element(begin, throughput.end());
+	res.cv = variation(m);
+	return res;
+}
+
+void steadyState::write(const std::string& filename, const config& cfg, const result& res)
+{
+	if (res.intervals == 0)
+	{
+		spdlog::warn("No counter interval after the {} ms warm-up, the summary is empty", cfg.warmup.count());
+	}
+	else
+	{
+		if (!res.steady)
+			spdlog::warn("No {} consecutive intervals with CV <= {}, the summary covers the whole run after the warm-up", cfg.window, cfg.maxCv);
+		spdlog::info("Throughput {:.1f} ± {:.1f} ops/s (CV {:.3f}, min {:.1f}, max {:.1f}) over {} intervals from {:.0f} ms", res.mean, res.stddev,
+			res.cv, res.min, res.max, res.steadyIntervals, res.steadyFromMs);
+	}
+
+	std::ofstream outfile(filename, std::ios::trunc);
+	if (outfile.is_open())
+	{
+		outfile << std::fixed << std::setprecision(3);
+		outfile << "=== Steady State ===" << "\n";
+		outfile << "Warm-up Discarded (ms): " << cfg.warmup.count() << "\n";
+		outfile << "Detection Window (intervals): " << cfg.window << "\n";
+		outfile << "Detection Max CV: " << cfg.maxCv << "\n";
+		outfile << "Intervals After Warm-up: " << res.intervals << "\n";
+		outfile << "Steady: " << (res.steady ? "yes" : "no") << "\n";
+		outfile << "Steady From (ms): " << res.steadyFromMs << "\n";
+		outfile << "Steady Intervals: " << res.steadyIntervals << "\n";
+		outfile << "Throughput Mean (ops/s): " << res.mean << "\n";
+		outfile << "Throughput Stddev (ops/s): " << res.stddev << "\n";
+		outfile << "Throughput Min (ops/s): " << res.min << "\n";
+		outfile << "Throughput Max (ops/s): " << res.max << "\n";
+		outfile << "Throughput CV: " << res.cv << "\n";
+		outfile << "====================" << "\n";
+		outfile.close();
+	}
+	else
+	{
+		spdlog::error("Failed to open file {} for writing!", filename);
+	}
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "benchmark/counter/counter-dumper.h"
+
+namespace cs
+{
+// Per-interval throughput of a run from its counter dump: intervals starting inside the warm-up window are dropped,
+// steady state begins with the first `window` consecutive intervals whose coefficient of variation is at most maxCv,
+// and the statistics cover everything from there to the end of the run.
+class steadyState
+{
+public:
+	struct config
+	{
+		std::chrono::milliseconds warmup;
+		size_t window; // intervals
+		double maxCv;
+	};
+
+	struct result
+	{
+		size_t intervals; // after the warm-up
+		bool steady;      // false - no window met maxCv, the statistics cover every interval after the warm-up
+		double steadyFromMs;
+		size_t steadyIntervals;
+		// Increments per second over the steady intervals
+		double mean;
+		double stddev;
+		double min;
+		double max;
+		double cv;
+	};
+
+	static result analyze(const std::vector<counterDumper::total>& totals, const config& cfg);
+
+	static void write(const std::string& filename, const config& cfg, const result& res);
+};
+} // namespace cs
@@ -0,0 +1,204 @@
+#include "benchmark/sweep/sweep-runner.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <memory>
+#include <numeric>
+#include <thread>
+
+#include <spdlog/spdlog.h>
+
+#include "benchmark/coro.h"
+#include "benchmark/counter/atomic-multiple-counter.h"
+#include "benchmark/latency/latency-recorder.h"
+#include "benchmark/locks/sync-targets.h"
+#include "benchmark/perf/perf-counters.h"
+
+#include "core/blocking-pool.h"
+#include "core/task-manager.h"
+#include "core/thread-pool.h"
+
+using namespace cs;
+
+namespace
+{
+// Two-sided 95% Student t critical values for 1..30 degrees of freedom
+constexpr double tCritical95[] = { 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120,
+	2.110, 2.101, 2.093, 2.086, 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042 };
+
+double tCritical(size_t degreesOfFreedom)
+{
+	if (degreesOfFreedom == 0)
+		return 0.0;
+	if (degreesOfFreedom <= std::size(tCritical95))
+		return tCritical95[degreesOfFreedom - 1];
+	return 1.960;
+}
+
+// Coroutines suspended on a mutex or queued on the pool need the pool to return after the stop
+constexpr std::chrono::seconds stopTimeout { 5 };
+} // namespace
+
+sweepRunner::sweepRunner(const config& cfg)
+: config_ { cfg }
+{ }
+
+void sweepRunner::run()
+{
+	results_.clear();
+	for (auto threads : config_.threads)
+	{
+		for (auto coros : config_.coros)
+		{
+			for (auto shared : config_.shared)
+			{
+				for (const auto& target : config_.targets)
+				{
+					results_.push_back(runPoint(threads, coros, shared, target));
+				}
+			}
+		}
+	}
+}
+
+sweepRunner::result sweepRunner::runPoint(uint64_t threads, uint64_t coros, uint64_t shared, const std::string& target)
+{
+	spdlog::info("Sweep point: threads {}, coro {}, shared {}, target {}", threads, coros, shared, target);
+
+	std::atomic<bool> running { true };
+	atomicMultipleCounter counter(shared, config_.counterShards);
+	latencyRecorder latency;
+	workload load(config_.load, shared);
+	syncTargets targets(target, shared, config_.lockStripes);
+	targets.setLockAffinity(config_.lockAffinity, threads);
+
+	// Waits are recorded over the trials only, like the throughput
+	latency.setRecording(false);
+
+	auto tp = std::make_shared<threadPool>(threads);
+	taskManager::instance().init(tp);
+	if (config_.blockingThreads != 0)
+		blockingPool::instance().start(config_.blockingThreads);
+	// Inherited by the workers, which are created afterwards
+	perfCounters perf(true);
+	perf.start();
+	tp->start();
+
+	startCoroutines(coros, counter, latency, load, running, targets, config_.mode, config_.blockingThreads != 0);
+	std::this_thread::sleep_for(config_.warmupTime);
+	latency.setRecording(true);
+
+	result res {};
+	res.threads = threads;
+	res.coros = coros;
+	res.shared = shared;
+	res.target = target;
+	for (size_t trial = 0; trial < config_.trials; ++trial)
+	{
+		auto before = counter.get_total();
+		auto start = std::chrono::steady_clock::now();
+		std::this_thread::sleep_for(config_.trialTime);
+		auto after = counter.get_total();
+		auto end = std::chrono::steady_clock::now();
+
+		double seconds = std::chrono::duration<double>(end - start).count();
+		res.throughput.push_back(static_cast<double>(after - before) / seconds);
+		spdlog::debug("  trial {}: {:.1f} ops/s", trial, res.throughput.back());
+	}
+
+	latency.setRecording(false);
+	running = false;
+	if (!waitCoroutines(stopTimeout))
+		spdlog::warn("  {} coroutines did not return within {} s, their frames are leaked", liveCoroutines(), stopTimeout.count());
+	// Offloaded calls still in flight resume their coroutines on tp
+	blockingPool::instance().stop();
+	tp->stop();
+	auto perfSample = perf.stop();
+	auto total = counter.get_total();
+	res.llcMissesPerOp = perfSample.valid[perfCounters::llcMisses] && total != 0
+		? static_cast<double>(perfSample.values[perfCounters::llcMisses]) / static_cast<double>(total)
+		: -1.0;
+
+	size_t n = res.throughput.size();
+	res.mean = n == 0 ? 0.0 : std::accumulate(res.throughput.begin(), res.throughput.end(), 0.0) / static_cast<double>(n);
+	double squares = 0.0;
+	for (auto value : res.throughput)
+	{
+		squares += (value - res.mean) * (value - res.mean);
+	}
+	res.stddev = n > 1 ? std::sqrt(squares / static_cast<double>(n - 1)) : 0.0;
+	double halfWidth = n > 1 ? tCritical(n - 1) * res.stddev / std::sqrt(static_cast<double>(n)) : 0.0;
+	res.ciLow = res.mean - halfWidth;
+	res.ciHigh = res.mean + halfWidth;
+
+	auto wait = latency.mergedWait();
+	res.waitP50 = wait.percentile(50);
+	res.waitP99 = wait.percentile(99);
+	res.waitP999 = wait.percentile(99.9);
+	res.waitMax = wait.max();
+
+	spdlog::info("  throughput {:.1f} ± {:.1f} ops/s (95% CI [{:.1f}, {:.1f}])", res.mean, res.stddev, res.ciLow, res.ciHigh);
+	return res;
+}
+
+const std::vector<sweepRunner::result>& sweepRunner::results() const
+{
+	return results_;
+}
+
+bool sweepRunner::dumpJson(const std::string& filename) const
+{
+	std::ofstream out(filename, std::ios_base::trunc);
+	if (!out.is_open())
+	{
+		spdlog::error("Failed to open file {} for writing!", filename);
+		return false;
+	}
+
+	out << "{\n";
+	out << "  \"warmup_ms\": " << config_.warmupTime.count() << ",\n";
+	out << "  \"trial_ms\": " << config_.trialTime.count() << ",\n";
+	out << "  \"trials\": " << config_.trials << ",\n";
+	out << "  \"counter_shards\": " << config_.counterShards << ",\n";
+	out << "  \"coro_mode\": \"" << toString(config_.mode) << "\",\n";
+	out << "  \"blocking_threads\": " << config_.blockingThreads << ",\n";
+	out << "  \"lock_affinity\": \"" << config_.lockAffinity << "\",\n";
+	out << "  \"lock_stripes\": " << config_.lockStripes << ",\n";
+	out << "  \"results\": [\n";
+	for (size_t i = 0; i < results_.size(); ++i)
+	{
+		const auto& res = results_[i];
+		out << "    { \"threads\": " << res.threads << ", \"coro\": " << res.coros << ", \"shared\": " << res.shared << ", \"target\": \"" << res.target << "\"";
+		out << ", \"throughput\": [";
+		for (size_t j = 0; j < res.throughput.size(); ++j)
+		{
+			out << (j == 0 ? "" : ", ") << res.throughput[j];
+		}
+		out << "], \"mean\": " << res.mean << ", \"stddev\": " << res.stddev << ", \"ci95_low\": " << res.ciLow << ", \"ci95_high\": " << res.ciHigh;
+		out << ", \"wait_p50_ns\": " << res.waitP50 << ", \"wait_p99_ns\": " << res.waitP99 << ", \"wait_p999_ns\": " << res.waitP999
+				<< ", \"wait_max_ns\": " << res.waitMax << ", \"llc_misses_per_op\": " << res.llcMissesPerOp << " }" << (i + 1 == results_.size() ? "" : ",") << "\n";
+	}
+	out << "  ]\n";
+	out << "}\n";
+	return true;
+}
+
+bool sweepRunner::dumpCsv(const std::string& filename) const
+{
+	std::ofstream out(filename, std::ios_base::trunc);
+	if (!out.is_open())
+	{
+		spdlog::error("Failed to open file {} for writing!", filename);
+		return false;
+	}
+
+	out << "threads,coro,shared,target,trials,mean,stddev,ci95_low,ci95_high,wait_p50_ns,wait_p99_ns,wait_p999_ns,wait_max_ns,llc_misses_per_op\n";
+	for (const auto& res : results_)
+	{
+		out << res.threads << "," << res.coros << "," << res.shared << "," << res.target << "," << res.throughput.size() << "," << res.mean << "," << res.stddev
+				<< "," << res.ciLow << "," << res.ciHigh << "," << res.waitP50 << "," << res.waitP99 << "," << res.waitP999 << "," << res.waitMax << "," << res.llcMissesPerOp << "\n";
+	}
+	return true;
+}
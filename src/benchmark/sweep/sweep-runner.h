@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "benchmark/coro.h"
+#include "benchmark/workload/workload.h"
+
+namespace cs
+{
+
+// Runs every threads x coroutines x shared objects x target combination in this process:
+// each point gets a fresh pool and primitives, a warm-up window and then back-to-back
+// measurement windows, whose throughputs are reduced to mean/stddev/95% confidence interval.
+class sweepRunner
+{
+public:
+	struct config
+	{
+		std::vector<uint64_t> threads;
+		std::vector<uint64_t> coros;
+		std::vector<uint64_t> shared;
+		std::vector<std::string> targets;
+		std::chrono::milliseconds warmupTime;
+		std::chrono::milliseconds trialTime;
+		size_t trials;
+		size_t counterShards;
+		workload::config load;
+		coroMode mode;
+		size_t blockingThreads; // 0 - blocking targets run on the pool workers
+		std::string lockAffinity; // syncTargets::setLockAffinity mode
+		size_t lockStripes;       // lt target
+	};
+
+	struct result
+	{
+		uint64_t threads;
+		uint64_t coros;
+		uint64_t shared;
+		std::string target;
+		std::vector<double> throughput; // increments per second, one per trial
+		double mean;
+		double stddev;
+		double ciLow;
+		double ciHigh;
+		uint64_t waitP50;
+		uint64_t waitP99;
+		uint64_t waitP999;
+		uint64_t waitMax;
+		// Whole point including warm-up, perfCounters::llcMisses over all increments; -1 without a PMU
+		double llcMissesPerOp;
+	};
+
+	explicit sweepRunner(const config& cfg);
+
+	void run();
+
+	const std::vector<result>& results() const;
+	bool dumpJson(const std::string& filename) const;
+	bool dumpCsv(const std::string& filename) const;
+
+private:
+	result runPoint(uint64_t threads, uint64_t coros, uint64_t shared, const std::string& target);
+
+	config config_;
+	std::vector<result> results_;
+};
+
+} // namespace cs
@@ -0,0 +1,91 @@
+#include "benchmark/workload/workload.h"
+
+#include <algorithm>
+#include <functional>
+#include <thread>
+
+#include <spdlog/spdlog.h>
+
+using namespace cs;
+
+namespace
+{
+void spinIterations(uint64_t iterations)
+{
+	for (uint64_t i = 0; i < iterations; ++i)
+	{
+		asm volatile("" ::: "memory");
+	}
+}
+
+// xorshift64, cheap per-thread source for the workload mix
+double nextUniform()
+{
+	static thread_local uint64_t state = 0x9E3779B97F4A7C15ull ^ std::hash<std::thread::id> {}(std::this_thread::get_id());
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+	return static_cast<double>(state >> 11) * 0x1.0p-53;
+}
+} // namespace
+
+workload::workload(const config& cfg, size_t sharedNumber)
+: config_ { cfg }
+, lines_(cfg.csLines * sharedNumber)
+{
+	if (config_.csSpin.count() > 0 || config_.thinkSpin.count() > 0 || config_.longCsSpin.count() > 0)
+		spinRate();
+}
+
+double workload::spinRate()
+{
+	static const double rate = []
+	{
+		constexpr uint64_t iterations = 1 << 22;
+		auto best = std::chrono::nanoseconds::max();
+		for (int attempt = 0; attempt < 5; ++attempt)
+		{
+			auto start = std::chrono::steady_clock::now();
+			spinIterations(iterations);
+			best = std::min(best, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start));
+		}
+		double result = static_cast<double>(iterations) / static_cast<double>(std::max<int64_t>(best.count(), 1));
+		spdlog::debug("Spin loop calibrated: {:.3f} iterations per ns", result);
+		return result;
+	}();
+	return rate;
+}
+
+void workload::spin(std::chrono::nanoseconds duration)
+{
+	if (duration.count() <= 0)
+		return;
+	spinIterations(static_cast<uint64_t>(static_cast<double>(duration.count()) * spinRate()));
+}
+
+void workload::criticalSection(size_t sharedIdx)
+{
+	line* lines = lines_.data() + sharedIdx * config_.csLines;
+	for (size_t i = 0; i < config_.csLines; ++i)
+	{
+		++lines[i].words[0];
+	}
+
+	if (config_.longRatio > 0.0 && nextUniform() < config_.longRatio)
+		spin(config_.longCsSpin);
+	else
+		spin(config_.csSpin);
+
+	if (config_.csSleep.count() > 0)
+		std::this_thread::sleep_for(config_.csSleep);
+}
+
+void workload::think() const
+{
+	spin(config_.thinkSpin);
+}
+
+const workload::config& workload::getConfig() const
+{
+	return config_;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace cs
+{
+
+// What a benchmark coroutine does around its lock: a critical section made of touching
+// csLines cache lines of the shared object's state, a calibrated CPU spin and an optional sleep,
+// and a calibrated think time spin after the release. With longRatio > 0 that share of
+// critical sections spins longCsSpin instead of csSpin (bimodal mix).
+class workload
+{
+public:
+	static constexpr size_t cacheLineSize = 64;
+
+	struct config
+	{
+		std::chrono::nanoseconds csSpin { 0 };
+		size_t csLines { 0 };
+		std::chrono::microseconds csSleep { 1000 };
+		std::chrono::nanoseconds thinkSpin { 0 };
+		double longRatio { 0.0 };
+		std::chrono::nanoseconds longCsSpin { 0 };
+	};
+
+	workload(const config& cfg, size_t sharedNumber);
+
+	workload(const workload&) = delete;
+	workload& operator= (const workload&) = delete;
+
+	// Must be called with the sharedIdx lock held
+	void criticalSection(size_t sharedIdx);
+	void think() const;
+
+	const config& getConfig() const;
+
+	// Busy-waits for roughly the given time without reading the clock
+	static void spin(std::chrono::nanoseconds duration);
+	// Spin loop iterations per nanosecond, measured once per process
+	static double spinRate();
+
+private:
+	struct alignas(cacheLineSize) line
+	{
+		uint64_t words[cacheLineSize / sizeof(uint64_t)] {};
+	};
+
+	config config_;
+	std::vector<line> lines_;
+};
+
+} // namespace cs
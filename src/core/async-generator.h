@@ -0,0 +1,161 @@
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "memory-accounting.h"
+
+namespace cs
+{
+
+// Coroutine producing a stream of T: the body may co_yield values and co_await anything (coroMutex, schedule_on...),
+// the consumer pulls elements one by one from another coroutine:
+//
+//	while (T* value = co_await generator.next())
+//		use(*value);
+//
+// A yielded value is not copied, next() returns the address of the co_yield operand, valid until the following
+// next() call. Only a const lvalue is copied into the producer frame, as next() hands out a mutable pointer.
+// The producer runs on the consumer's thread until it suspends on its own co_await, the consumer then continues
+// on whatever thread resumes the producer.
+// Destroying the generator destroys the producer frame: stop early only while the producer is suspended at
+// co_yield, i.e. not while a next() is in flight.
+template<typename T>
+class async_generator
+{
+public:
+	using value_type = std::remove_reference_t<T>;
+
+	struct promise_type
+	{
+		using coro_handle = std::coroutine_handle<promise_type>;
+
+		// Hands control back to the consumer waiting in next()
+		struct transferAwaiter
+		{
+			bool await_ready() noexcept { return false; }
+			std::coroutine_handle<> await_suspend(coro_handle handle) noexcept { return handle.promise().consumer; }
+			void await_resume() noexcept { }
+		};
+
+		std::suspend_always initial_suspend() noexcept { return {}; }
+		transferAwaiter final_suspend() noexcept { return {}; }
+
+		async_generator get_return_object() { return async_generator { coro_handle::from_promise(*this) }; }
+
+		void unhandled_exception() noexcept { exception = std::current_exception(); }
+
+		static void* operator new(std::size_t size) { return memoryAccounting::allocateFrame(size); }
+		static void operator delete(void* ptr, std::size_t size) noexcept { memoryAccounting::freeFrame(ptr, size); }
+		void return_void() noexcept { }
+
+		// The operand outlives the suspension, both for lvalues and for temporaries of the co_yield expression
+		transferAwaiter yield_value(value_type& value) noexcept
+		{
+			current = std::addressof(value);
+			return {};
+		}
+
+		transferAwaiter yield_value(value_type&& value) noexcept
+		{
+			current = std::addressof(value);
+			return {};
+		}
+
+		// For a const value_type the first overload takes const lvalues already
+		transferAwaiter yield_value(const value_type& value)
+			requires(!std::is_const_v<value_type>)
+		{
+			current = std::addressof(copy.emplace(value));
+			return {};
+		}
+
+		value_type* current { nullptr };
+		std::optional<value_type> copy;
+		std::coroutine_handle<> consumer;
+		std::exception_ptr exception;
+	};
+
+	using coro_handle = std::coroutine_handle<promise_type>;
+
+	class nextAwaiter
+	{
+	public:
+		explicit nextAwaiter(coro_handle producer) noexcept
+		: producer_(producer)
+		{ }
+
+		bool await_ready() const noexcept { return !producer_ || producer_.done(); }
+
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<> consumer) noexcept
+		{
+			producer_.promise().consumer = consumer;
+			return producer_;
+		}
+
+		// nullptr once the producer returned, rethrows what escaped its body
+		value_type* await_resume()
+		{
+			if (!producer_)
+				return nullptr;
+			auto& promise = producer_.promise();
+			if (producer_.done())
+			{
+				if (promise.exception)
+					std::rethrow_exception(std::exchange(promise.exception, nullptr));
+				return nullptr;
+			}
+			return promise.current;
+		}
+
+	private:
+		coro_handle producer_;
+	};
+
+	async_generator() noexcept = default;
+
+	explicit async_generator(coro_handle handle) noexcept
+	: handle_(handle)
+	{ }
+
+	async_generator(const async_generator&) = delete;
+	async_generator& operator= (const async_generator&) = delete;
+
+	async_generator(async_generator&& other) noexcept
+	: handle_(std::exchange(other.handle_, nullptr))
+	{ }
+
+	async_generator& operator= (async_generator&& other) noexcept
+	{
+		if (this != &other)
+		{
+			reset();
+			handle_ = std::exchange(other.handle_, nullptr);
+		}
+		return *this;
+	}
+
+	~async_generator() { reset(); }
+
+	// Resumes the producer up to its next co_yield or return
+	nextAwaiter next() noexcept { return nextAwaiter { handle_ }; }
+
+	bool done() const noexcept { return !handle_ || handle_.done(); }
+
+private:
+	void reset() noexcept
+	{
+		if (handle_)
+			handle_.destroy();
+		handle_ = nullptr;
+	}
+
+	coro_handle handle_;
+};
+
+} // namespace cs
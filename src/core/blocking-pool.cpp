@@ -0,0 +1,86 @@
+#include "blocking-pool.h"
+
+#include "trace.h"
+
+namespace cs
+{
+blockingPool::blockingPool() { }
+
+blockingPool::~blockingPool()
+{
+	stop();
+}
+
+void blockingPool::start(size_t threadsCount)
+{
+	std::lock_guard<std::mutex> lock(mtx_);
+	if (running_)
+		return;
+
+	running_ = true;
+	threads_.reserve(threadsCount);
+	for (size_t i = 0; i < threadsCount; ++i)
+	{
+		threads_.emplace_back([this]() { worker(); });
+	}
+}
+
+void blockingPool::stop() noexcept
+{
+	{
+		std::lock_guard<std::mutex> lock(mtx_);
+		if (!running_)
+			return;
+		running_ = false;
+	}
+	cv_.notify_all();
+
+	for (auto& thread : threads_)
+	{
+		if (thread.joinable())
+			thread.join();
+	}
+	threads_.clear();
+}
+
+bool blockingPool::submit(task_t&& task)
+{
+	{
+		std::lock_guard<std::mutex> lock(mtx_);
+		if (!running_)
+			return false;
+		tasks_.push_back(std::move(task));
+	}
+	cv_.notify_one();
+	return true;
+}
+
+size_t blockingPool::threadsCount() const
+{
+	std::lock_guard<std::mutex> lock(mtx_);
+	return threads_.size();
+}
+
+void blockingPool::worker()
+{
+	while (true)
+	{
+		task_t task;
+		{
+			std::unique_lock<std::mutex> lock(mtx_);
+			if (running_ && tasks_.empty())
+			{
+				trace::record(trace::event::park);
+				cv_.wait(lock, [this]() { return !running_ || !tasks_.empty(); });
+				trace::record(trace::event::unpark);
+			}
+			// Queued tasks are drained on stop
+			if (tasks_.empty())
+				return;
+			task = std::move(tasks_.front());
+			tasks_.pop_front();
+		}
+		task();
+	}
+}
+} // namespace cs
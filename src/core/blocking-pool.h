@@ -0,0 +1,44 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "singleton.h"
+
+namespace cs
+{
+// Threads for calls that block (locks held by threads, sleeps, syscalls), kept apart from the coroutine
+// executors. Unlike threadPool its workers sleep while there is nothing to run, since they are expected
+// to spend their time blocked anyway.
+class blockingPool : public singleton<blockingPool>
+{
+public:
+	using task_t = std::function<void()>;
+
+	blockingPool();
+	~blockingPool();
+
+	void start(size_t threadsCount);
+	// Runs the tasks already queued, then joins the threads. Stop it before the executors the offloaded
+	// coroutines resume on, so every queued coroutine still gets resumed.
+	void stop() noexcept;
+
+	// False if the pool is not running, the task is not queued then
+	bool submit(task_t&& task);
+
+	size_t threadsCount() const;
+
+private:
+	void worker();
+
+	std::vector<std::thread> threads_;
+	std::deque<task_t> tasks_;
+	mutable std::mutex mtx_;
+	std::condition_variable cv_;
+	bool running_ { false };
+};
+} // namespace cs
@@ -0,0 +1,115 @@
+#include "coro-lock-table.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <thread>
+
+namespace cs
+{
+void coroLockTable::stripe::acquire() noexcept
+{
+	size_t spins = 0;
+	while (guard.exchange(true, std::memory_order_acquire))
+	{
+		while (guard.load(std::memory_order_relaxed))
+		{
+			if (++spins % 64 == 0)
+				std::this_thread::yield();
+		}
+	}
+}
+
+void coroLockTable::stripe::release() noexcept
+{
+	guard.store(false, std::memory_order_release);
+}
+
+coroLockTable::coroLockTable(size_t stripes)
+: stripes_ { std::make_unique<stripe[]>(std::bit_ceil(std::max<size_t>(stripes, 1))) }
+, mask_ { std::bit_ceil(std::max<size_t>(stripes, 1)) - 1 }
+{ }
+
+bool coroLockTable::awaiter::await_ready() noexcept
+{
+	// Taken when free, otherwise await_suspend queues up (or takes it if released meanwhile)
+	stripe_.acquire();
+	bool free = !stripe_.locked;
+	stripe_.locked = true;
+	stripe_.release();
+	return free;
+}
+
+bool coroLockTable::awaiter::await_suspend(std::coroutine_handle<> handle) noexcept
+{
+	node_.handle = handle;
+	node_.origin = &executor::current();
+	node_.next = nullptr;
+
+	stripe_.acquire();
+	if (!stripe_.locked)
+	{
+		stripe_.locked = true;
+		stripe_.release();
+		return false;
+	}
+	if (stripe_.tail)
+		stripe_.tail->next = &node_;
+	else
+		stripe_.head = &node_;
+	stripe_.tail = &node_;
+	// The node may be resumed as soon as the guard is released
+	stripe_.release();
+	return true;
+}
+
+coroLockTable::awaiter coroLockTable::lock(size_t key)
+{
+	return awaiter { stripes_[stripeOf(key)] };
+}
+
+void coroLockTable::unlock(size_t key)
+{
+	auto& s = stripes_[stripeOf(key)];
+	s.acquire();
+	node* next = s.head;
+	if (next)
+	{
+		// Handed over, the stripe stays locked
+		s.head = next->next;
+		if (!s.head)
+			s.tail = nullptr;
+	}
+	else
+		s.locked = false;
+	s.release();
+
+	if (next)
+		next->origin->execute(next->handle);
+}
+
+bool coroLockTable::locked(size_t key) const
+{
+	auto& s = stripes_[stripeOf(key)];
+	s.acquire();
+	bool result = s.locked;
+	s.release();
+	return result;
+}
+
+size_t coroLockTable::stripeOf(size_t key) const
+{
+	// Fibonacci hashing spreads consecutive keys over the stripes
+	return static_cast<size_t>((static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ull) >> 32) & mask_;
+}
+
+size_t coroLockTable::stripesCount() const
+{
+	return mask_ + 1;
+}
+
+size_t coroLockTable::memoryUsage() const
+{
+	return sizeof(*this) + stripesCount() * sizeof(stripe);
+}
+} // namespace cs
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <memory>
+
+#include "executor.h"
+
+namespace cs
+{
+// Asynchronous locks for an unbounded key space: keys are hashed onto a fixed power-of-two set of stripes,
+// keys sharing a stripe share its lock. A stripe is one cache line (no false sharing between neighbours),
+// its waiters are an intrusive FIFO of nodes living in the awaiting coroutines' frames, so memory does not
+// depend on the number of keys or waiters. Waiters are resumed on the executor they called lock() from.
+class coroLockTable
+{
+	struct node
+	{
+		std::coroutine_handle<> handle;
+		executor* origin;
+		node* next;
+	};
+
+	struct alignas(64) stripe
+	{
+		// Spin guard of the fields below, held for a few instructions only
+		std::atomic<bool> guard { false };
+		bool locked { false };
+		node* head { nullptr };
+		node* tail { nullptr };
+
+		void acquire() noexcept;
+		void release() noexcept;
+	};
+
+public:
+	static constexpr size_t defaultStripes = 1024;
+
+	explicit coroLockTable(size_t stripes = defaultStripes);
+
+	struct awaiter
+	{
+		bool await_ready() noexcept;
+		bool await_suspend(std::coroutine_handle<> handle) noexcept;
+		void await_resume() noexcept { }
+
+		stripe& stripe_;
+		node node_ { };
+	};
+
+	// co_await lock(key) takes the lock of key's stripe
+	awaiter lock(size_t key);
+	// Releases the lock of key's stripe, handing it to its first waiter if any
+	void unlock(size_t key);
+	bool locked(size_t key) const;
+
+	size_t stripeOf(size_t key) const;
+	size_t stripesCount() const;
+	// Bytes owned by the table, independent of the keys used
+	size_t memoryUsage() const;
+
+private:
+	std::unique_ptr<stripe[]> stripes_;
+	size_t mask_;
+};
+} // namespace cs
@@ -1,6 +1,8 @@
 #include "coro-mutex.h"
 
-#include "task-manager.h"
+#include "trace.h"
+
+#include <thread>
 
 cs::coroMutex::awaiter::awaiter(cs::coroMutex& cm, bool locked)
 : cm_ { cm }
@@ -9,19 +11,49 @@ cs::coroMutex::awaiter::awaiter(cs::coroMutex& cm, bool locked)
 
 bool cs::coroMutex::awaiter::await_ready()
 {
-	return !locked_;
+	if (locked_)
+		return false;
+	if (!cm_.away() && executor::consumeBudget())
+		return true;
+	yield_ = true;
+	return false;
 }
 
-void cs::coroMutex::awaiter::await_suspend(std::coroutine_handle<> handle)
+bool cs::coroMutex::awaiter::await_suspend(std::coroutine_handle<> handle)
 {
-	cm_.queue_.enqueue(handle);
+	if (yield_)
+	{
+		// We own the lock: queue up and release it, unlock() hands it to the first waiter,
+		// which is us when nobody else waits, and resumes us behind the executor's pending work
+		cm_.waiters_.fetch_add(1);
+		cm_.queue_.enqueue(waiter { handle, &executor::current(), true });
+		// Not a release in the trace: the acquisition is recorded once we are resumed
+		cm_.release();
+		return true;
+	}
+
+	cm_.waiters_.fetch_add(1);
+	// The mutex may have been released since lock(), take it instead of waiting
+	if (!cm_.locked_.exchange(true))
+	{
+		cm_.waiters_.fetch_sub(1);
+		return false;
+	}
+	// Nothing can touch the mutex after this point: the handle may be resumed right away
+	// and the mutex destroyed by its last user
+	cm_.queue_.enqueue(waiter { handle, &executor::current(), false });
 	// cm_.queue_.push(handle);
+	return true;
 }
 
-void cs::coroMutex::awaiter::await_resume() { }
+void cs::coroMutex::awaiter::await_resume()
+{
+	trace::record(trace::event::lockAcquire, &cm_);
+}
 
 cs::coroMutex::awaiter cs::coroMutex::lock()
 {
+	trace::record(trace::event::lockRequest, this);
 	bool expected = locked_.load();
 	while (!locked_.compare_exchange_weak(expected, true))
 	{
@@ -32,19 +64,129 @@ cs::coroMutex::awaiter cs::coroMutex::lock()
 
 void cs::coroMutex::unlock()
 {
-	std::coroutine_handle<> handle;
-	if (queue_.try_dequeue(handle))
-	// if (queue_.pop(handle))
+	trace::record(trace::event::lockRelease, this);
+	if (learn_ && home_.load(std::memory_order_relaxed) == executor::noAffinity)
+		home_.store(executor::current().affinity(), std::memory_order_relaxed);
+	release();
+}
+
+void cs::coroMutex::release()
+{
+	while (true)
 	{
-		cs::taskManager::instance().execute(handle);
+		combine();
+
+		if (waiters_.load() != 0)
+		{
+			// The lock is held, so a committed waiter cannot take it and enqueues itself shortly
+			waiter next;
+			if (queue_.try_dequeue(next))
+			// if (queue_.pop(handle))
+			{
+				waiters_.fetch_sub(1);
+				resume(next);
+				return;
+			}
+			std::this_thread::yield();
+			continue;
+		}
+
+		if (published_.load() != 0)
+		{
+			// Out of the batch: the next publisher gets the mutex and carries on combining
+			delegate* next;
+			if (delegates_.try_dequeue(next))
+			{
+				published_.fetch_sub(1);
+				next->handedOver = true;
+				resume(waiter { next->handle, next->origin, false });
+				return;
+			}
+			std::this_thread::yield();
+			continue;
+		}
+
+		locked_.store(false);
+		// Pairs with fetch_add/exchange in await_suspend and publish: either the waiter sees the mutex free,
+		// or we see the waiter and must hand the mutex over if we manage to take it back
+		if ((waiters_.load() == 0 && published_.load() == 0) || locked_.exchange(true))
+			return;
 	}
+}
+
+void cs::coroMutex::resume(const waiter& next)
+{
+	trace::record(trace::event::handoff, this);
+	size_t home = home_.load(std::memory_order_relaxed);
+	// Already on the home worker (or no home): the executor keeps it local anyway
+	if (home != executor::noAffinity && next.origin->affinity() != home)
+		next.origin->executeNear(next.handle, home);
+	else if (next.yield)
+		next.origin->yield(next.handle);
 	else
+		next.origin->execute(next.handle);
+}
+
+bool cs::coroMutex::publish(delegate& d)
+{
+	published_.fetch_add(1);
+	if (!locked_.exchange(true))
 	{
-		locked_.store(false);
+		published_.fetch_sub(1);
+		return false;
+	}
+	// Last access, the closure may run and the coroutine be resumed right away
+	delegates_.enqueue(&d);
+	return true;
+}
+
+void cs::coroMutex::combine()
+{
+	size_t done = 0;
+	while (done < combineLimit && published_.load() != 0)
+	{
+		delegate* next;
+		if (!delegates_.try_dequeue(next))
+		{
+			// A committed publisher enqueues shortly
+			std::this_thread::yield();
+			continue;
+		}
+		published_.fetch_sub(1);
+		waiter owner { next->handle, next->origin, false };
+		next->invoke(*next);
+		resume(owner);
+		++done;
 	}
 }
 
+bool cs::coroMutex::away() const
+{
+	size_t home = home_.load(std::memory_order_relaxed);
+	if (home == executor::noAffinity)
+		return false;
+	size_t worker = executor::current().affinity();
+	return worker != executor::noAffinity && worker != home;
+}
+
 std::atomic<bool>& cs::coroMutex::locked()
 {
 	return locked_;
+}
+
+void cs::coroMutex::setAffinity(size_t worker)
+{
+	learn_ = false;
+	home_.store(worker);
+}
+
+void cs::coroMutex::learnAffinity()
+{
+	learn_ = true;
+	home_.store(executor::noAffinity);
+}
+
+size_t cs::coroMutex::affinity() const
+{
+	return home_.load();
 }
\ No newline at end of file
@@ -2,38 +2,170 @@
 
 #include <atomic>
 #include <coroutine>
+#include <type_traits>
+#include <utility>
 
 // #include "lf-queue.h"
 #include "concurrentqueue.h"
+#include "deferred-call.h"
+#include "executor.h"
+#include "memory-accounting.h"
 // #include "ts-queue.h"
 namespace cs
 {
+template<typename F>
+class runAwaiter;
+
+// Waiters are resumed on the executor they called lock() from. The waiters queue has no FIFO order across
+// the threads pushing to it, so waiters are not served in arrival order. An uncontended lock() spends one operation
+// of the coroutine's executor budget, when the budget is exhausted the coroutine queues up with the waiters
+// and yields instead of taking the lock.
+// With a home worker set, waiters are resumed on that worker of their executor, and a coroutine finding the mutex
+// free on another worker hands the lock to itself through the waiters queue, moving there first. Coroutines sharing
+// the mutex then run on one worker and the data it protects stays in that worker's cache, other workers can still
+// steal them from its queue.
+// run(fn) delegates the critical section: a caller finding the mutex taken publishes fn and suspends, whoever
+// releases the mutex runs a batch of published closures first (flat combining), so the protected data stays
+// in the releasing core's cache instead of travelling with the lock.
 class coroMutex
 {
 public:
 	friend struct awaiter;
+	template<typename F>
+	friend class runAwaiter;
 
 	struct awaiter
 	{
 		awaiter(coroMutex& cm, bool locked);
 
 		bool await_ready();
-		void await_suspend(std::coroutine_handle<> handle);
+		bool await_suspend(std::coroutine_handle<> handle);
 		void await_resume();
 
 	private:
 		coroMutex& cm_;
 		bool locked_;
+		// The lock was free but the coroutine is out of budget or away from the home worker,
+		// it queues up behind the waiters instead
+		bool yield_ { false };
 	};
 
 	awaiter lock();
 	void unlock();
 
+	// co_await run(fn) returns fn() executed under the mutex, by this coroutine or by the current holder.
+	// fn must not lock this mutex. An exception thrown by fn is rethrown in the awaiting coroutine.
+	template<typename F>
+	runAwaiter<std::decay_t<F>> run(F&& fn);
+
+	// Published closures a releasing holder runs before it hands the lock over
+	static constexpr size_t combineLimit = 64;
+
 	std::atomic<bool>& locked();
+
+	// Fixed home worker, executor::noAffinity - none (default). Set before the mutex is used.
+	void setAffinity(size_t worker);
+	// The home becomes the worker that releases the mutex first. Set before the mutex is used.
+	void learnAffinity();
+	size_t affinity() const;
+
 private:
+	// Whether the calling coroutine runs on a worker other than the home one
+	bool away() const;
+
+	struct waiter
+	{
+		std::coroutine_handle<> handle;
+		executor* origin;
+		bool yield;
+	};
+
+	void resume(const waiter& next);
+	// unlock() without the trace event and the affinity learning
+	void release();
+
+	// Closure published by run(), lives in the publisher's frame until it is resumed
+	struct delegate
+	{
+		void (*invoke)(delegate&);
+		std::coroutine_handle<> handle;
+		executor* origin;
+		// Resumed holding the mutex to run its closure and the pending ones itself
+		bool handedOver { false };
+	};
+
+	// Queues d unless the mutex can be taken, true - d is queued and its coroutine will be resumed
+	bool publish(delegate& d);
+	// Runs up to combineLimit published closures, the mutex is held
+	void combine();
+
 	// lfQueue<std::coroutine_handle<>> queue_;
-	moodycamel::ConcurrentQueue<std::coroutine_handle<>> queue_;
+	accountedQueue<waiter> queue_;
 	// tsQueue<std::coroutine_handle<>> queue_;
 	std::atomic<bool> locked_ { false };
+	// Coroutines that decided to wait and are in queue_ or about to be
+	std::atomic<size_t> waiters_ { 0 };
+	std::atomic<size_t> home_ { executor::noAffinity };
+	bool learn_ { false };
+
+	accountedQueue<delegate*> delegates_;
+	// Closures that are in delegates_ or about to be
+	std::atomic<size_t> published_ { 0 };
 };
+
+template<typename F>
+class runAwaiter : private coroMutex::delegate
+{
+	using result_t = typename deferredCall<F>::result_t;
+
+public:
+	runAwaiter(coroMutex& cm, F fn)
+	: coroMutex::delegate { &runAwaiter::invoke, {}, nullptr }
+	, cm_ { cm }
+	, call_ { std::move(fn) }
+	{ }
+
+	bool await_ready()
+	{
+		if (cm_.locked_.load(std::memory_order_relaxed) || cm_.locked_.exchange(true))
+			return false;
+		runAndUnlock();
+		return true;
+	}
+
+	bool await_suspend(std::coroutine_handle<> h)
+	{
+		handle = h;
+		origin = &executor::current();
+		if (cm_.publish(*this))
+			return true;
+		runAndUnlock();
+		return false;
+	}
+
+	result_t await_resume()
+	{
+		if (handedOver)
+			runAndUnlock();
+		return call_.result();
+	}
+
+private:
+	static void invoke(coroMutex::delegate& d) { static_cast<runAwaiter&>(d).call_.run(); }
+
+	void runAndUnlock()
+	{
+		call_.run();
+		cm_.unlock();
+	}
+
+	coroMutex& cm_;
+	deferredCall<F> call_;
+};
+
+template<typename F>
+runAwaiter<std::decay_t<F>> coroMutex::run(F&& fn)
+{
+	return runAwaiter<std::decay_t<F>> { *this, std::forward<F>(fn) };
+}
 } // namespace cs
\ No newline at end of file
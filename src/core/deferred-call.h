@@ -0,0 +1,55 @@
+#pragma once
+
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace cs
+{
+// A callable run by somebody else (another thread, the holder of a mutex) on behalf of a suspended coroutine,
+// together with its outcome: run() keeps the returned value or the thrown exception, result() hands it over
+// once the coroutine is resumed.
+template<typename F>
+class deferredCall
+{
+public:
+	using result_t = std::invoke_result_t<F&>;
+
+	explicit deferredCall(F fn)
+	: fn_ { std::move(fn) }
+	{ }
+
+	void run() noexcept
+	{
+		try
+		{
+			if constexpr (std::is_void_v<result_t>)
+				fn_();
+			else
+				result_.emplace(fn_());
+		}
+		catch (...)
+		{
+			exception_ = std::current_exception();
+		}
+	}
+
+	// Rethrows the exception thrown by run() or returns the value
+	result_t result()
+	{
+		if (exception_)
+			std::rethrow_exception(exception_);
+		if constexpr (!std::is_void_v<result_t>)
+			return std::move(*result_);
+	}
+
+private:
+	struct empty
+	{ };
+
+	F fn_;
+	std::conditional_t<std::is_void_v<result_t>, empty, std::optional<result_t>> result_;
+	std::exception_ptr exception_;
+};
+} // namespace cs
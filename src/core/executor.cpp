@@ -0,0 +1,77 @@
+#include "executor.h"
+
+#include "task-manager.h"
+
+#include <limits>
+
+namespace cs
+{
+namespace
+{
+constexpr size_t unlimitedBudget = std::numeric_limits<size_t>::max();
+
+thread_local executor* currentExecutor = nullptr;
+thread_local size_t budgetLeft = unlimitedBudget;
+} // namespace
+
+void executor::execute(task&& taskToExecute)
+{
+	if (!taskToExecute.handle())
+		return;
+	taskToExecute.handle().promise().detached = true;
+	execute(std::coroutine_handle<>(taskToExecute.handle()));
+}
+
+void executor::yield(std::coroutine_handle<> handle)
+{
+	execute(handle);
+}
+
+size_t executor::affinity() const
+{
+	return noAffinity;
+}
+
+void executor::executeNear(std::coroutine_handle<> handle, size_t)
+{
+	execute(handle);
+}
+
+executor& executor::current()
+{
+	if (currentExecutor)
+		return *currentExecutor;
+	return taskManager::instance();
+}
+
+void executor::setBudget(size_t operations)
+{
+	budget_ = operations;
+}
+
+size_t executor::budget() const
+{
+	return budget_;
+}
+
+bool executor::consumeBudget()
+{
+	if (budgetLeft == unlimitedBudget)
+		return true;
+	if (budgetLeft == 0)
+		return false;
+	--budgetLeft;
+	return true;
+}
+
+void executor::resume(std::coroutine_handle<> handle)
+{
+	executor* previous = currentExecutor;
+	size_t previousBudget = budgetLeft;
+	currentExecutor = this;
+	budgetLeft = budget_ == 0 ? unlimitedBudget : budget_;
+	handle.resume();
+	currentExecutor = previous;
+	budgetLeft = previousBudget;
+}
+} // namespace cs
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <limits>
+
+#include "task.h"
+
+namespace cs
+{
+// Something that resumes coroutine handles: a thread pool, a dedicated thread, the calling thread.
+// Implementations resume handles through resume(), so the coroutine can find the executor it runs on.
+class executor
+{
+public:
+	virtual ~executor() = default;
+
+	virtual void execute(std::coroutine_handle<> handle) = 0;
+	// Detaches the task, its frame is destroyed once the coroutine completes
+	void execute(task&& taskToExecute);
+	// Reschedules a coroutine that gives up its turn: behind the work already queued where possible
+	virtual void yield(std::coroutine_handle<> handle);
+
+	static constexpr size_t noAffinity = std::numeric_limits<size_t>::max();
+
+	// Index of this executor's worker the calling thread is, noAffinity on other threads
+	// and for executors without separate workers
+	virtual size_t affinity() const;
+	// Resumes the handle preferably on the given worker, idle workers may still steal it
+	virtual void executeNear(std::coroutine_handle<> handle, size_t worker);
+
+	// Executor resuming the calling coroutine, taskManager outside of any executor
+	static executor& current();
+
+	// Operations a coroutine may run each time it is resumed by this executor before awaitables
+	// that would not suspend (e.g. an uncontended coroMutex::lock()) make it yield, 0 - unlimited
+	virtual void setBudget(size_t operations);
+	size_t budget() const;
+
+	// Spends one operation of the running coroutine's budget, false once it is exhausted
+	static bool consumeBudget();
+
+protected:
+	void resume(std::coroutine_handle<> handle);
+
+	size_t budget_ { 0 };
+};
+
+struct scheduleOnAwaiter
+{
+	executor& exec;
+
+	bool await_ready() noexcept { return false; }
+	void await_suspend(std::coroutine_handle<> handle) { exec.execute(handle); }
+	void await_resume() noexcept { }
+};
+
+// co_await schedule_on(exec) continues the coroutine on exec
+inline scheduleOnAwaiter schedule_on(executor& exec)
+{
+	return scheduleOnAwaiter { exec };
+}
+
+struct yieldAwaiter
+{
+	bool await_ready() noexcept { return false; }
+	void await_suspend(std::coroutine_handle<> handle) { executor::current().yield(handle); }
+	void await_resume() noexcept { }
+};
+
+// co_await yield() lets the other coroutines of the current executor run and continues after them
+inline yieldAwaiter yield()
+{
+	return yieldAwaiter {};
+}
+
+} // namespace cs
@@ -0,0 +1,10 @@
+#include "inline-executor.h"
+
+namespace cs
+{
+void inlineExecutor::execute(std::coroutine_handle<> handle)
+{
+	if (!handle.done())
+		resume(handle);
+}
+} // namespace cs
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "executor.h"
+
+namespace cs
+{
+// Resumes handles right away on the calling thread
+class inlineExecutor : public executor
+{
+public:
+	using executor::execute;
+	void execute(std::coroutine_handle<> handle) override;
+};
+} // namespace cs
@@ -0,0 +1,299 @@
+#include "memory-accounting.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace cs
+{
+namespace
+{
+std::atomic<bool> accounting { false };
+
+// Written by its thread only (plain load + store, no read-modify-write), summed by take().
+// Frees are counted by the freeing thread, so a single thread's live values may go negative.
+struct alignas(64) threadCounters
+{
+	std::atomic<int64_t> liveFrames { 0 };
+	std::atomic<int64_t> totalFrames { 0 };
+	std::atomic<int64_t> frameBytes { 0 };
+	std::array<std::atomic<int64_t>, memoryAccounting::frameSizeClasses> liveFramesBySize {};
+	std::array<std::atomic<int64_t>, memoryAccounting::frameSizeClasses> frameBytesBySize {};
+	std::atomic<int64_t> queueBlocks { 0 };
+	std::atomic<int64_t> queueBytes { 0 };
+
+	// Not yet folded into the shared totals the peaks are tracked on
+	int64_t pendingFrames { 0 };
+	int64_t pendingFrameBytes { 0 };
+};
+
+// A thread folds its frame changes into these every peakLagFrames frames and when it exits,
+// queue blocks are rare and folded right away
+struct alignas(64) sharedTotals
+{
+	std::atomic<int64_t> liveFrames { 0 };
+	std::atomic<int64_t> frameBytes { 0 };
+	std::atomic<int64_t> queueBytes { 0 };
+	std::atomic<int64_t> peakLiveFrames { 0 };
+	std::atomic<int64_t> peakFrameBytes { 0 };
+	std::atomic<int64_t> peakQueueBytes { 0 };
+};
+
+// Counters outlive their threads, so blocks freed after a thread exited still balance. An exited thread's
+// counters are handed to the next new thread, the registry grows to the most threads alive at once only.
+struct registry
+{
+	std::mutex mtx;
+	std::vector<std::unique_ptr<threadCounters>> threads;
+	std::vector<threadCounters*> released;
+	sharedTotals totals;
+};
+
+registry& counters()
+{
+	static registry instance;
+	return instance;
+}
+
+void add(std::atomic<int64_t>& counter, int64_t delta)
+{
+	counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+void raisePeak(std::atomic<int64_t>& peak, int64_t value)
+{
+	int64_t current = peak.load(std::memory_order_relaxed);
+	while (current < value && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed))
+	{ }
+}
+
+void foldFrames(threadCounters& c)
+{
+	auto& totals = counters().totals;
+	raisePeak(totals.peakLiveFrames, totals.liveFrames.fetch_add(c.pendingFrames, std::memory_order_relaxed) + c.pendingFrames);
+	raisePeak(totals.peakFrameBytes, totals.frameBytes.fetch_add(c.pendingFrameBytes, std::memory_order_relaxed) + c.pendingFrameBytes);
+	c.pendingFrames = 0;
+	c.pendingFrameBytes = 0;
+}
+
+// Folds what is still pending when the thread exits, so the shared totals do not drift, and releases the counters
+struct localCounters
+{
+	threadCounters* counters { nullptr };
+
+	~localCounters()
+	{
+		if (counters == nullptr)
+			return;
+		foldFrames(*counters);
+		auto& reg = cs::counters();
+		std::lock_guard<std::mutex> lock(reg.mtx);
+		reg.released.push_back(std::exchange(counters, nullptr));
+	}
+};
+
+threadCounters& local()
+{
+	static thread_local localCounters cached;
+	if (cached.counters == nullptr)
+	{
+		auto& reg = counters();
+		std::lock_guard<std::mutex> lock(reg.mtx);
+		if (!reg.released.empty())
+		{
+			// Keeps its sums, the new thread just adds to them
+			cached.counters = reg.released.back();
+			reg.released.pop_back();
+		}
+		else
+		{
+			reg.threads.push_back(std::make_unique<threadCounters>());
+			cached.counters = reg.threads.back().get();
+		}
+	}
+	return *cached.counters;
+}
+
+// Header in front of every frame and queue block, so a block is uncounted on free only if it was counted
+// on allocation, whatever the setting is by then. Keeps the alignment of anything for the block after it.
+struct alignas(alignof(std::max_align_t)) blockHeader
+{
+	size_t size;
+	bool counted;
+};
+
+// Sums are read while other threads may still allocate and free: a free seen before its allocation
+// can leave a moment's total below zero
+uint64_t snapshotValue(int64_t value)
+{
+	return value < 0 ? 0 : static_cast<uint64_t>(value);
+}
+} // namespace
+
+void memoryAccounting::enable(bool enabled)
+{
+	accounting.store(compiled && enabled);
+}
+
+bool memoryAccounting::enabled()
+{
+	return accounting.load(std::memory_order_relaxed);
+}
+
+memoryAccounting::snapshot memoryAccounting::take()
+{
+	auto& reg = counters();
+	std::lock_guard<std::mutex> lock(reg.mtx);
+
+	int64_t liveFrames = 0;
+	int64_t totalFrames = 0;
+	int64_t frameBytes = 0;
+	std::array<int64_t, frameSizeClasses> liveFramesBySize {};
+	std::array<int64_t, frameSizeClasses> frameBytesBySize {};
+	int64_t queueBlocks = 0;
+	int64_t queueBytes = 0;
+	for (const auto& c : reg.threads)
+	{
+		liveFrames += c->liveFrames.load(std::memory_order_relaxed);
+		totalFrames += c->totalFrames.load(std::memory_order_relaxed);
+		frameBytes += c->frameBytes.load(std::memory_order_relaxed);
+		for (size_t i = 0; i < frameSizeClasses; ++i)
+		{
+			liveFramesBySize[i] += c->liveFramesBySize[i].load(std::memory_order_relaxed);
+			frameBytesBySize[i] += c->frameBytesBySize[i].load(std::memory_order_relaxed);
+		}
+		queueBlocks += c->queueBlocks.load(std::memory_order_relaxed);
+		queueBytes += c->queueBytes.load(std::memory_order_relaxed);
+	}
+
+	snapshot result {};
+	result.liveFrames = snapshotValue(liveFrames);
+	result.totalFrames = snapshotValue(totalFrames);
+	result.frameBytes = snapshotValue(frameBytes);
+	for (size_t i = 0; i < frameSizeClasses; ++i)
+	{
+		result.liveFramesBySize[i] = snapshotValue(liveFramesBySize[i]);
+		result.frameBytesBySize[i] = snapshotValue(frameBytesBySize[i]);
+	}
+	result.queueBlocks = snapshotValue(queueBlocks);
+	result.queueBytes = snapshotValue(queueBytes);
+	// The folded peaks lag behind the exact sums
+	result.peakLiveFrames = std::max(result.liveFrames, snapshotValue(reg.totals.peakLiveFrames.load()));
+	result.peakFrameBytes = std::max(result.frameBytes, snapshotValue(reg.totals.peakFrameBytes.load()));
+	result.peakQueueBytes = std::max(result.queueBytes, snapshotValue(reg.totals.peakQueueBytes.load()));
+	return result;
+}
+
+size_t memoryAccounting::sizeClassLimit(size_t sizeClass)
+{
+	return sizeClass + 1 >= frameSizeClasses ? 0 : size_t { 64 } << sizeClass;
+}
+
+size_t memoryAccounting::sizeClass(size_t size)
+{
+	if (size <= 64)
+		return 0;
+	size_t cls = static_cast<size_t>(std::bit_width(size - 1)) - 6;
+	return cls < frameSizeClasses ? cls : frameSizeClasses - 1;
+}
+
+void* memoryAccounting::allocateFrame(size_t size)
+{
+	if constexpr (!compiled)
+		return ::operator new(size);
+
+	void* raw = ::operator new(sizeof(blockHeader) + size);
+	auto* header = new (raw) blockHeader { size, enabled() };
+	if (!header->counted)
+		return header + 1;
+
+	auto& c = local();
+	auto bytes = static_cast<int64_t>(sizeof(blockHeader) + size);
+	size_t cls = sizeClass(size);
+	add(c.liveFrames, 1);
+	add(c.totalFrames, 1);
+	add(c.frameBytes, bytes);
+	add(c.liveFramesBySize[cls], 1);
+	add(c.frameBytesBySize[cls], bytes);
+	c.pendingFrameBytes += bytes;
+	if (++c.pendingFrames >= static_cast<int64_t>(memoryAccounting::peakLagFrames))
+		foldFrames(c);
+	return header + 1;
+}
+
+void memoryAccounting::freeFrame(void* ptr, size_t size) noexcept
+{
+	if constexpr (!compiled)
+	{
+		::operator delete(ptr, size);
+		return;
+	}
+
+	auto* header = static_cast<blockHeader*>(ptr) - 1;
+	if (header->counted)
+	{
+		auto& c = local();
+		auto bytes = static_cast<int64_t>(sizeof(blockHeader) + size);
+		size_t cls = sizeClass(size);
+		add(c.liveFrames, -1);
+		add(c.frameBytes, -bytes);
+		add(c.liveFramesBySize[cls], -1);
+		add(c.frameBytesBySize[cls], -bytes);
+		c.pendingFrameBytes -= bytes;
+		if (--c.pendingFrames <= -static_cast<int64_t>(memoryAccounting::peakLagFrames))
+			foldFrames(c);
+	}
+	::operator delete(header, sizeof(blockHeader) + size);
+}
+
+void* memoryAccounting::allocateQueue(size_t size)
+{
+	if constexpr (!compiled)
+		return std::malloc(size);
+
+	void* raw = std::malloc(sizeof(blockHeader) + size);
+	if (!raw)
+		return nullptr;
+
+	auto* header = new (raw) blockHeader { size, enabled() };
+	if (header->counted)
+	{
+		auto& c = local();
+		auto bytes = static_cast<int64_t>(size);
+		add(c.queueBlocks, 1);
+		add(c.queueBytes, bytes);
+		auto& totals = counters().totals;
+		raisePeak(totals.peakQueueBytes, totals.queueBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+	}
+	return header + 1;
+}
+
+void memoryAccounting::freeQueue(void* ptr) noexcept
+{
+	if constexpr (!compiled)
+	{
+		std::free(ptr);
+		return;
+	}
+
+	if (!ptr)
+		return;
+
+	auto* header = static_cast<blockHeader*>(ptr) - 1;
+	if (header->counted)
+	{
+		auto& c = local();
+		auto bytes = static_cast<int64_t>(header->size);
+		add(c.queueBlocks, -1);
+		add(c.queueBytes, -bytes);
+		counters().totals.queueBytes.fetch_sub(bytes, std::memory_order_relaxed);
+	}
+	std::free(header);
+}
+} // namespace cs
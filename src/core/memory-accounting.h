@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "concurrentqueue.h"
+
+namespace cs
+{
+// Opt-in accounting of coroutine frames (task and async_generator) and of the blocks allocated by the pool's
+// and the mutexes' queues. Only built with -DBUILD_MEMORY_ACCOUNTING=ON (CS_MEMORY_ACCOUNTING defined): otherwise
+// blocks come straight from operator new and malloc, enable() is ignored and take() stays zero.
+// Built in, every block carries a small header recording whether it was counted, so the setting may change at any
+// time. Counters are per thread and summed by take(), peaks are tracked on shared totals updated every few dozen
+// frames per thread.
+class memoryAccounting
+{
+public:
+#ifdef CS_MEMORY_ACCOUNTING
+	static constexpr bool compiled = true;
+#else
+	static constexpr bool compiled = false;
+#endif
+
+	// Live frames are split by size: up to 64 bytes, up to 128, ..., up to 4096, larger
+	static constexpr size_t frameSizeClasses = 8;
+	// Peaks may miss up to this many frames per running thread, live values and totals are exact
+	static constexpr size_t peakLagFrames = 64;
+
+	struct snapshot
+	{
+		uint64_t liveFrames;
+		uint64_t peakLiveFrames;
+		uint64_t totalFrames; // counted allocations, never reset
+		uint64_t frameBytes;  // including the per-frame header
+		uint64_t peakFrameBytes;
+		std::array<uint64_t, frameSizeClasses> liveFramesBySize;
+		std::array<uint64_t, frameSizeClasses> frameBytesBySize;
+		uint64_t queueBlocks;
+		uint64_t queueBytes;
+		uint64_t peakQueueBytes;
+	};
+
+	static void enable(bool enabled);
+	static bool enabled();
+	static snapshot take();
+
+	// Upper bound of a size class, 0 for the last (unbounded) one
+	static size_t sizeClassLimit(size_t sizeClass);
+
+	static void* allocateFrame(size_t size);
+	static void freeFrame(void* ptr, size_t size) noexcept;
+
+	// Queue blocks also carry their size in the header, so they can be freed without it
+	static void* allocateQueue(size_t size);
+	static void freeQueue(void* ptr) noexcept;
+
+private:
+	static size_t sizeClass(size_t size);
+};
+
+// moodycamel traits routing the queue's block allocations through memoryAccounting
+struct accountedQueueTraits : moodycamel::ConcurrentQueueDefaultTraits
+{
+	static void* malloc(size_t size) { return memoryAccounting::allocateQueue(size); }
+	static void free(void* ptr) { memoryAccounting::freeQueue(ptr); }
+};
+
+template<typename T>
+using accountedQueue = moodycamel::ConcurrentQueue<T, accountedQueueTraits>;
+} // namespace cs
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <coroutine>
+#include <type_traits>
+#include <utility>
+
+#include "blocking-pool.h"
+#include "deferred-call.h"
+#include "executor.h"
+
+namespace cs
+{
+template<typename F>
+class offloadBlockingAwaiter
+{
+public:
+	using result_t = typename deferredCall<F>::result_t;
+
+	offloadBlockingAwaiter(blockingPool& pool, F fn)
+	: pool_ { pool }
+	, call_ { std::move(fn) }
+	{ }
+
+	bool await_ready() noexcept { return false; }
+
+	bool await_suspend(std::coroutine_handle<> handle)
+	{
+		origin_ = &executor::current();
+		// The last access to the awaiter on the blocking thread is before execute(), the frame may be gone after it
+		bool submitted = pool_.submit(
+			[this, handle]()
+			{
+				call_.run();
+				origin_->execute(handle);
+			});
+		if (submitted)
+			return true;
+		// No blocking pool running, block the current thread
+		call_.run();
+		return false;
+	}
+
+	result_t await_resume() { return call_.result(); }
+
+private:
+	blockingPool& pool_;
+	deferredCall<F> call_;
+	executor* origin_ { nullptr };
+};
+
+// co_await offload_blocking(fn) runs fn on the blocking pool and continues the coroutine with its result
+// on the executor it was running on. Without a running blocking pool fn runs on the calling thread.
+template<typename F>
+offloadBlockingAwaiter<std::decay_t<F>> offload_blocking(F&& fn)
+{
+	return offloadBlockingAwaiter<std::decay_t<F>>(blockingPool::instance(), std::forward<F>(fn));
+}
+
+template<typename F>
+offloadBlockingAwaiter<std::decay_t<F>> offload_blocking(blockingPool& pool, F&& fn)
+{
+	return offloadBlockingAwaiter<std::decay_t<F>>(pool, std::forward<F>(fn));
+}
+} // namespace cs
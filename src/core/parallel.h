@@ -0,0 +1,247 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "executor.h"
+#include "task.h"
+
+namespace cs
+{
+namespace detail
+{
+// Splitting of [begin, end): with an explicit grain, halves until chunks are not larger than grain.
+// With grain 0 a chunk is split splitDepth times, plus stealBonus more whenever it was stolen by another
+// thread (somebody is idle and wants work), so the grain adapts to the load instead of the range size.
+struct splitPolicy
+{
+	static constexpr size_t stealBonus = 2;
+
+	size_t grain;
+	size_t splitDepth;
+
+	static splitPolicy make(size_t grain)
+	{
+		size_t workers = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+		// About 4 chunks per worker before any stealing
+		return { grain, static_cast<size_t>(std::bit_width(workers)) + 2 };
+	}
+};
+
+// Shared by all chunks of one parallel call, lives in the awaiting coroutine's frame until the last chunk resumes it
+template<typename Index, typename Body>
+struct joinState
+{
+	joinState(Index first, Index last, splitPolicy split, Body& fn)
+	: begin { first }
+	, end { last }
+	, policy { split }
+	, body { fn }
+	{ }
+
+	Index begin;
+	Index end;
+	splitPolicy policy;
+	Body& body;
+	std::coroutine_handle<> continuation;
+	executor* origin { nullptr };
+	std::atomic<size_t> pending { 1 };
+	std::atomic<bool> failed { false };
+	std::exception_ptr exception;
+
+	void fail() noexcept
+	{
+		if (!failed.exchange(true))
+			exception = std::current_exception();
+	}
+
+	void finishChunk()
+	{
+		// Last access to the state, the continuation may destroy it right away
+		if (pending.fetch_sub(1) == 1)
+			origin->execute(continuation);
+	}
+};
+
+template<typename Index, typename Body>
+task chunk(joinState<Index, Body>* state, Index begin, Index end, size_t splits, std::thread::id spawner)
+{
+	if (state->policy.grain == 0 && std::this_thread::get_id() != spawner)
+		splits += splitPolicy::stealBonus;
+
+	const size_t minChunk = state->policy.grain == 0 ? 1 : state->policy.grain;
+	while (static_cast<size_t>(end - begin) > minChunk && (state->policy.grain != 0 || splits != 0))
+	{
+		Index mid = begin + (end - begin) / 2;
+		if (splits != 0)
+			--splits;
+		state->pending.fetch_add(1);
+		executor::current().execute(chunk(state, mid, end, splits, std::this_thread::get_id()));
+		end = mid;
+	}
+
+	if (!state->failed.load(std::memory_order_relaxed))
+	{
+		try
+		{
+			state->body(begin, end);
+		}
+		catch (...)
+		{
+			state->fail();
+		}
+	}
+	state->finishChunk();
+	co_return;
+}
+
+// Calls body(chunkBegin, chunkEnd) for disjoint chunks covering [begin, end) as tasks on the current
+// executor, the awaiting coroutine is resumed by whichever chunk finishes last
+template<typename Index, typename Body>
+class parallelAwaiter
+{
+public:
+	template<typename... Args>
+	parallelAwaiter(Index begin, Index end, size_t grain, Args&&... args)
+	: body_ { std::forward<Args>(args)... }
+	, state_ { begin, end, splitPolicy::make(grain), body_ }
+	{ }
+
+	parallelAwaiter(parallelAwaiter&& other) = delete;
+
+	bool await_ready() const noexcept { return !(state_.begin < state_.end); }
+
+	void await_suspend(std::coroutine_handle<> handle)
+	{
+		state_.continuation = handle;
+		state_.origin = &executor::current();
+		state_.origin->execute(chunk(&state_, state_.begin, state_.end, state_.policy.splitDepth, std::this_thread::get_id()));
+	}
+
+	void await_resume()
+	{
+		if (state_.exception)
+			std::rethrow_exception(state_.exception);
+	}
+
+protected:
+	Body body_;
+	joinState<Index, Body> state_;
+};
+
+template<typename Index, typename F>
+struct forBody
+{
+	F fn;
+
+	void operator() (Index begin, Index end)
+	{
+		for (Index i = begin; i < end; ++i)
+			fn(i);
+	}
+};
+
+// Result of one chunk, chunks push them to a lock-free list and the awaiting coroutine folds it once all finished
+template<typename T>
+struct partialResult
+{
+	T value;
+	partialResult* next;
+};
+
+template<typename Index, typename T, typename Map, typename Reduce>
+struct reduceBody
+{
+	reduceBody(Map mapFn, Reduce reduceFn, T identityValue)
+	: map { std::move(mapFn) }
+	, reduce { std::move(reduceFn) }
+	, identity { std::move(identityValue) }
+	{ }
+
+	reduceBody(const reduceBody&) = delete;
+	reduceBody& operator= (const reduceBody&) = delete;
+
+	~reduceBody()
+	{
+		// Left over if the awaiter is destroyed without being resumed
+		auto* node = partials.load();
+		while (node != nullptr)
+			delete std::exchange(node, node->next);
+	}
+
+	void operator() (Index begin, Index end)
+	{
+		if (begin == end)
+			return;
+		T partial = map(begin);
+		for (Index i = begin + 1; i < end; ++i)
+			partial = reduce(std::move(partial), map(i));
+
+		auto* node = new partialResult<T> { std::move(partial), partials.load(std::memory_order_relaxed) };
+		while (!partials.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed))
+		{ }
+	}
+
+	// Called after the last chunk finished
+	T collect()
+	{
+		T result = std::move(identity);
+		// Unlinked one at a time, the destructor frees the rest if reduce throws
+		while (auto* node = partials.load(std::memory_order_relaxed))
+		{
+			std::unique_ptr<partialResult<T>> current(node);
+			partials.store(node->next, std::memory_order_relaxed);
+			result = reduce(std::move(result), std::move(current->value));
+		}
+		return result;
+	}
+
+	Map map;
+	Reduce reduce;
+	T identity;
+	std::atomic<partialResult<T>*> partials { nullptr };
+};
+
+template<typename Index, typename T, typename Map, typename Reduce>
+class reduceAwaiter : public parallelAwaiter<Index, reduceBody<Index, T, Map, Reduce>>
+{
+	using base_t = parallelAwaiter<Index, reduceBody<Index, T, Map, Reduce>>;
+
+public:
+	using base_t::base_t;
+
+	T await_resume()
+	{
+		base_t::await_resume();
+		return this->body_.collect();
+	}
+};
+} // namespace detail
+
+// co_await parallel_for(begin, end, grain, fn) calls fn(i) for every i in [begin, end) on the current executor's
+// workers and continues once all calls returned, without blocking a worker. grain 0 - adaptive chunk size.
+// The first exception thrown by fn is rethrown in the awaiting coroutine, chunks not started yet are skipped.
+template<typename Index, typename F>
+detail::parallelAwaiter<Index, detail::forBody<Index, std::decay_t<F>>> parallel_for(Index begin, Index end, size_t grain, F&& fn)
+{
+	return { begin, end, grain, std::forward<F>(fn) };
+}
+
+// co_await parallel_reduce(begin, end, grain, identity, map, reduce) returns identity reduced with map(i) for every i
+// in [begin, end). reduce must be associative and commutative: chunk results are combined in no particular order,
+// by the awaiting coroutine once every chunk finished, so workers never wait on each other.
+template<typename Index, typename T, typename Map, typename Reduce>
+detail::reduceAwaiter<Index, T, std::decay_t<Map>, std::decay_t<Reduce>> parallel_reduce(Index begin, Index end, size_t grain, T identity, Map&& map,
+	Reduce&& reduce)
+{
+	return { begin, end, grain, std::forward<Map>(map), std::forward<Reduce>(reduce), std::move(identity) };
+}
+} // namespace cs
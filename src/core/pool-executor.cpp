@@ -0,0 +1,40 @@
+#include "pool-executor.h"
+
+namespace cs
+{
+poolExecutor::poolExecutor(std::shared_ptr<threadPool> tp)
+: tp_ { std::move(tp) }
+{ }
+
+void poolExecutor::execute(std::coroutine_handle<> handle)
+{
+	if (handle.done())
+		return;
+	tp_->pushTask([this, handle]() { resume(handle); });
+}
+
+void poolExecutor::yield(std::coroutine_handle<> handle)
+{
+	if (handle.done())
+		return;
+	tp_->yieldTask([this, handle]() { resume(handle); });
+}
+
+size_t poolExecutor::affinity() const
+{
+	size_t worker = tp_->currentWorkerIndex();
+	return worker == threadPool::npos ? noAffinity : worker;
+}
+
+void poolExecutor::executeNear(std::coroutine_handle<> handle, size_t worker)
+{
+	if (handle.done())
+		return;
+	tp_->pushTaskTo(worker, [this, handle]() { resume(handle); });
+}
+
+threadPool& poolExecutor::pool()
+{
+	return *tp_;
+}
+} // namespace cs
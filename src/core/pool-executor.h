@@ -0,0 +1,27 @@
+#pragma once
+
+#include <memory>
+
+#include "executor.h"
+#include "thread-pool.h"
+
+namespace cs
+{
+// Resumes handles on the workers of a thread pool, the pool is started and stopped by its owner
+class poolExecutor : public executor
+{
+public:
+	explicit poolExecutor(std::shared_ptr<threadPool> tp);
+
+	using executor::execute;
+	void execute(std::coroutine_handle<> handle) override;
+	void yield(std::coroutine_handle<> handle) override;
+	size_t affinity() const override;
+	void executeNear(std::coroutine_handle<> handle, size_t worker) override;
+
+	threadPool& pool();
+
+private:
+	std::shared_ptr<threadPool> tp_;
+};
+} // namespace cs
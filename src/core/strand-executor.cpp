@@ -0,0 +1,34 @@
+#include "strand-executor.h"
+
+namespace cs
+{
+strandExecutor::strandExecutor()
+: tp_ { 1 }
+{
+	tp_.start();
+}
+
+strandExecutor::~strandExecutor()
+{
+	stop();
+}
+
+void strandExecutor::execute(std::coroutine_handle<> handle)
+{
+	if (handle.done())
+		return;
+	tp_.pushTask([this, handle]() { resume(handle); });
+}
+
+void strandExecutor::yield(std::coroutine_handle<> handle)
+{
+	if (handle.done())
+		return;
+	tp_.yieldTask([this, handle]() { resume(handle); });
+}
+
+void strandExecutor::stop()
+{
+	tp_.stop();
+}
+} // namespace cs
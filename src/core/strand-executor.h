@@ -0,0 +1,29 @@
+#pragma once
+
+#include <memory>
+
+#include "executor.h"
+#include "thread-pool.h"
+
+namespace cs
+{
+// Resumes handles one at a time on its own thread, coroutines scheduled on it never run concurrently
+class strandExecutor : public executor
+{
+public:
+	strandExecutor();
+	~strandExecutor();
+
+	strandExecutor(const strandExecutor& other) = delete;
+	strandExecutor& operator= (const strandExecutor& other) = delete;
+
+	using executor::execute;
+	void execute(std::coroutine_handle<> handle) override;
+	void yield(std::coroutine_handle<> handle) override;
+
+	void stop();
+
+private:
+	threadPool tp_;
+};
+} // namespace cs
@@ -1,27 +1,51 @@
 #include "task-manager.h"
 
+#include "pool-executor.h"
+
 namespace cs
 {
 taskManager::taskManager() { }
 
 void taskManager::init(std::shared_ptr<threadPool> tp)
 {
-	tp_ = tp;
+	executor_ = std::make_shared<poolExecutor>(tp);
+	executor_->setBudget(budget_);
+}
+
+void taskManager::init(std::shared_ptr<executor> exec)
+{
+	executor_ = exec;
+	if (executor_)
+		executor_->setBudget(budget_);
+}
+
+void taskManager::execute(std::coroutine_handle<> taskToExecute)
+{
+	if (!taskToExecute.done() && executor_)
+		executor_->execute(taskToExecute);
+}
+
+void taskManager::setBudget(size_t operations)
+{
+	budget_ = operations;
+	if (executor_)
+		executor_->setBudget(operations);
+}
+
+void taskManager::yield(std::coroutine_handle<> taskToExecute)
+{
+	if (!taskToExecute.done() && executor_)
+		executor_->yield(taskToExecute);
 }
 
-void taskManager::execute(std::coroutine_handle<>& taskToExecute)
+size_t taskManager::affinity() const
 {
-	auto lambdaTask = [handle = taskToExecute]() mutable
-	{
-		handle.resume();
-	};
-	if (!taskToExecute.done() && tp_)
-		tp_->pushTask(std::move(lambdaTask));
+	return executor_ ? executor_->affinity() : noAffinity;
 }
 
-void taskManager::execute(task&& taskToExecute)
+void taskManager::executeNear(std::coroutine_handle<> taskToExecute, size_t worker)
 {
-    std::coroutine_handle<> handle = taskToExecute.handle();
-	execute(handle);
+	if (!taskToExecute.done() && executor_)
+		executor_->executeNear(taskToExecute, worker);
 }
-} // namespace cs
\ No newline at end of file
+} // namespace cs
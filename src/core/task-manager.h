@@ -5,22 +5,31 @@
 
 #include "singleton.h"
 
+#include "executor.h"
 #include "task.h"
 #include "thread-pool.h"
 
 namespace cs
 {
-class taskManager : public singleton<taskManager>
+// Process-wide default executor, forwards to the executor it was initialized with
+class taskManager : public singleton<taskManager>, public executor
 {
 public:
 	taskManager();
 
+	// Runs coroutines on the workers of tp
 	void init(std::shared_ptr<threadPool> tp);
+	void init(std::shared_ptr<executor> exec);
 
-	void execute(std::coroutine_handle<>& taskToExecute);
-	void execute(task&& taskToExecute);
+	using executor::execute;
+	void execute(std::coroutine_handle<> taskToExecute) override;
+	void yield(std::coroutine_handle<> taskToExecute) override;
+	size_t affinity() const override;
+	void executeNear(std::coroutine_handle<> taskToExecute, size_t worker) override;
+	// Applies to the executor taskManager was initialized with
+	void setBudget(size_t operations) override;
 
 private:
-	std::shared_ptr<threadPool> tp_ { nullptr };
+	std::shared_ptr<executor> executor_ { nullptr };
 };
-} // namespace cs
\ No newline at end of file
+} // namespace cs
@@ -1,6 +1,7 @@
 #include "task.h"
 
-#include "task-manager.h"
+#include "memory-accounting.h"
+
 #include <coroutine>
 #include <utility>
 
@@ -9,9 +10,9 @@ std::suspend_always cs::task::promise_type::initial_suspend() noexcept
 	return std::suspend_always {};
 }
 
-std::suspend_always cs::task::promise_type::final_suspend() noexcept
+cs::task::promise_type::finalAwaiter cs::task::promise_type::final_suspend() noexcept
 {
-	return std::suspend_always {};
+	return finalAwaiter { detached };
 }
 
 void cs::task::promise_type::unhandled_exception() { }
@@ -23,11 +24,14 @@ cs::task cs::task::promise_type::get_return_object()
 
 void cs::task::promise_type::return_void() { }
 
-template <>
-std::suspend_always cs::task::promise_type::await_transform<std::suspend_always>(std::suspend_always)
+void* cs::task::promise_type::operator new(std::size_t size)
 {
-	taskManager::instance().execute(coro_handle::from_promise(*this));
-	return std::suspend_always {};
+	return memoryAccounting::allocateFrame(size);
+}
+
+void cs::task::promise_type::operator delete(void* ptr, std::size_t size) noexcept
+{
+	memoryAccounting::freeFrame(ptr, size);
 }
 
 cs::task::task(coro_handle handle)
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <coroutine>
+#include <cstddef>
 
 namespace cs
 {
@@ -12,17 +13,28 @@ public:
 	{
 		using coro_handle = std::coroutine_handle<promise_type>;
 
+		struct finalAwaiter
+		{
+			bool detached;
+
+			bool await_ready() noexcept { return detached; }
+			void await_suspend(std::coroutine_handle<>) noexcept { }
+			void await_resume() noexcept { }
+		};
+
 		std::suspend_always initial_suspend() noexcept;
-		std::suspend_always final_suspend() noexcept;
+		finalAwaiter final_suspend() noexcept;
 		void unhandled_exception();
 		task get_return_object();
 		void return_void();
 
-		template<typename T>
-		T await_transform(T value)
-		{
-			return value;
-		}
+		// Frames are allocated through memoryAccounting
+		static void* operator new(std::size_t size);
+		static void operator delete(void* ptr, std::size_t size) noexcept;
+
+		// Set once the task is handed over to executor::execute, nobody owns the frame then
+		// and it is destroyed as soon as the coroutine completes
+		bool detached { false };
 	};
 
 	using coro_handle = std::coroutine_handle<promise_type>;
@@ -1,26 +1,49 @@
 #include "thread-pool.h"
 
+#include "trace.h"
+
+#include <algorithm>
 #include <random>
 
 namespace cs
 {
+namespace
+{
+// Pool and index of the worker running on this thread
+thread_local threadPool* currentPool = nullptr;
+thread_local size_t currentWorker = 0;
+} // namespace
+
 threadPool::threadPool(size_t workersCount)
 : workersCount_(workersCount)
-, queues_(workersCount)
+, capacity_(workersCount)
 , running_(false)
-{
-	workers_.reserve(workersCount_);
-}
+, queues_(workersCount)
+, locals_(workersCount)
+{ }
 
 void threadPool::start()
 {
 	if (running_.exchange(true))
 		return;
 
-	for (size_t i = 0; i < workersCount_; ++i)
+	size_t initial = workersCount_;
+	if (elastic_)
+		initial = std::clamp(workersCount_, elasticConfig_.minWorkers, elasticConfig_.maxWorkers);
+
+	startTime_ = std::chrono::steady_clock::now();
+	workers_ = std::vector<std::thread>(capacity_);
+	states_ = std::vector<workerState>(capacity_);
+	activeWorkers_ = initial;
+	peakWorkers_ = initial;
+
+	for (size_t i = 0; i < initial; ++i)
 	{
-		workers_.emplace_back([this, i]() { worker(i); });
+		spawnWorker(i);
 	}
+
+	if (elastic_)
+		monitor_ = std::thread([this]() { monitor(); });
 }
 
 void threadPool::stop() noexcept
@@ -28,6 +51,9 @@ void threadPool::stop() noexcept
 	if (!running_.exchange(false))
 		return;
 
+	if (monitor_.joinable())
+		monitor_.join();
+
 	for (auto& worker : workers_)
 	{
 		if (worker.joinable())
@@ -36,6 +62,25 @@ void threadPool::stop() noexcept
 
 	workers_.clear();
 	queues_.clear();
+	locals_.clear();
+}
+
+void threadPool::setWorkerHooks(workerHook_t onStart, workerHook_t onStop)
+{
+	onWorkerStart_ = std::move(onStart);
+	onWorkerStop_ = std::move(onStop);
+}
+
+void threadPool::setElastic(const elasticConfig& config)
+{
+	elastic_ = true;
+	elasticConfig_ = config;
+	elasticConfig_.minWorkers = std::max<size_t>(elasticConfig_.minWorkers, 1);
+	elasticConfig_.maxWorkers = std::max(elasticConfig_.maxWorkers, elasticConfig_.minWorkers);
+
+	capacity_ = elasticConfig_.maxWorkers;
+	queues_ = std::vector<accountedQueue<task_t>>(capacity_);
+	locals_ = std::vector<workerLocal>(capacity_);
 }
 
 void threadPool::pushTask(task_t&& task)
@@ -43,12 +88,65 @@ void threadPool::pushTask(task_t&& task)
 	if (!running_.load(std::memory_order_relaxed))
 		return;
 
-	// Простой рандомный выбор очереди для балансировки
-	static thread_local std::mt19937 generator(std::random_device {}());
-	std::uniform_int_distribution<size_t> distribution(0, workersCount_ - 1);
-	size_t index = distribution(generator);
+	if (localPush_ && currentPool == this)
+	{
+		auto& local = locals_[currentWorker];
+		task_t displaced;
+		if (takeRunNext(local, displaced))
+			queues_[currentWorker].enqueue(std::move(displaced));
+		// A stealer is still moving the previous task out
+		if (local.runNextState.load(std::memory_order_acquire) != runNextEmpty)
+		{
+			queues_[currentWorker].enqueue(std::move(task));
+			return;
+		}
+		local.runNext = std::move(task);
+		local.runNextSinceNs.store(sinceStart(), std::memory_order_relaxed);
+		local.runNextState.store(runNextFull, std::memory_order_release);
+		return;
+	}
+
+	queues_[pickQueue()].enqueue(std::move(task));
+}
+
+void threadPool::yieldTask(task_t&& task)
+{
+	if (!running_.load(std::memory_order_relaxed))
+		return;
+
+	if (currentPool == this)
+	{
+		queues_[currentWorker].enqueue(std::move(task));
+		return;
+	}
+	pushTask(std::move(task));
+}
 
-	queues_[index].enqueue(std::move(task));
+void threadPool::pushTaskTo(size_t worker, task_t&& task)
+{
+	if (!running_.load(std::memory_order_relaxed))
+		return;
+
+	worker %= capacity_;
+	if (currentPool == this && currentWorker == worker)
+	{
+		pushTask(std::move(task));
+		return;
+	}
+	// A retired worker's queue would only be served by stealers
+	if (elastic_ && !states_[worker].active.load(std::memory_order_relaxed))
+		worker = pickQueue();
+	queues_[worker].enqueue(std::move(task));
+}
+
+size_t threadPool::currentWorkerIndex() const
+{
+	return currentPool == this ? currentWorker : npos;
+}
+
+void threadPool::setLocalPush(bool enabled)
+{
+	localPush_ = enabled;
 }
 
 void threadPool::pushTask(const task_t& task)
@@ -60,36 +158,247 @@ void threadPool::pushTask(const task_t& task)
 	pushTask(std::move(copy));
 }
 
+bool threadPool::takeRunNext(workerLocal& local, task_t& task)
+{
+	uint8_t expected = runNextFull;
+	if (!local.runNextState.compare_exchange_strong(expected, runNextTaking, std::memory_order_acquire))
+		return false;
+	task = std::move(local.runNext);
+	local.runNext = nullptr;
+	local.runNextState.store(runNextEmpty, std::memory_order_release);
+	return true;
+}
+
+bool threadPool::stealRunNext(workerLocal& local, task_t& task)
+{
+	if (local.runNextState.load(std::memory_order_acquire) != runNextFull)
+		return false;
+	if (std::chrono::nanoseconds(sinceStart() - local.runNextSinceNs.load(std::memory_order_relaxed)) < runNextGrace)
+		return false;
+	return takeRunNext(local, task);
+}
+
+size_t threadPool::pickQueue()
+{
+	// Простой рандомный выбор очереди для балансировки
+	static thread_local std::mt19937 generator(std::random_device {}());
+	std::uniform_int_distribution<size_t> distribution(0, capacity_ - 1);
+	size_t index = distribution(generator);
+
+	if (!elastic_)
+		return index;
+
+	// A retired worker's queue would only be served by stealers
+	for (size_t i = 0; i < capacity_; ++i)
+	{
+		size_t candidate = (index + i) % capacity_;
+		if (states_[candidate].active.load(std::memory_order_relaxed))
+			return candidate;
+	}
+	return index;
+}
+
+void threadPool::spawnWorker(size_t thread_idx)
+{
+	// A retired worker may still be leaving the slot
+	if (workers_[thread_idx].joinable())
+		workers_[thread_idx].join();
+
+	states_[thread_idx].startedNs = sinceStart();
+	states_[thread_idx].active = true;
+	workers_[thread_idx] = std::thread([this, thread_idx]() { worker(thread_idx); });
+}
+
+void threadPool::monitor()
+{
+	bool queuedBefore = false;
+	while (running_.load(std::memory_order_relaxed))
+	{
+		std::this_thread::sleep_for(elasticConfig_.growAfter);
+
+		size_t queued = 0;
+		for (auto& queue : queues_)
+			queued += queue.size_approx();
+
+		size_t active = activeWorkers_.load();
+		if (queued != 0 && queuedBefore && active < capacity_)
+		{
+			for (size_t i = 0; i < capacity_; ++i)
+			{
+				if (states_[i].active.load())
+					continue;
+				{
+					std::lock_guard<std::mutex> lock(statsMtx_);
+					recordResize(activeWorkers_.fetch_add(1) + 1, true);
+				}
+				spawnWorker(i);
+				break;
+			}
+		}
+		queuedBefore = queued != 0;
+	}
+}
+
+void threadPool::recordResize(size_t workers, bool grow)
+{
+	events_.push_back({ std::chrono::nanoseconds(sinceStart()), workers });
+	peakWorkers_ = std::max(peakWorkers_, workers);
+	if (grow)
+		++grows_;
+	else
+		++shrinks_;
+}
+
+int64_t threadPool::sinceStart() const
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime_).count();
+}
+
+threadPool::stats threadPool::getStats() const
+{
+	std::lock_guard<std::mutex> lock(statsMtx_);
+	stats result { activeWorkers_.load(), peakWorkers_, grows_, shrinks_, 0.0, events_ };
+
+	uint64_t alive = 0;
+	uint64_t idle = 0;
+	for (const auto& state : states_)
+	{
+		alive += state.aliveNs.load();
+		idle += state.idleNs.load();
+		if (state.active.load() && running_.load())
+			alive += static_cast<uint64_t>(sinceStart() - state.startedNs.load());
+	}
+	if (alive != 0)
+		result.utilization = 1.0 - static_cast<double>(std::min(idle, alive)) / static_cast<double>(alive);
+	return result;
+}
+
+size_t threadPool::workersCount() const
+{
+	return activeWorkers_.load();
+}
+
+size_t threadPool::capacity() const
+{
+	return capacity_;
+}
+
 void threadPool::worker(size_t thread_idx)
 {
 	auto& local_queue = queues_[thread_idx];
+	auto& local = locals_[thread_idx];
+	auto& state = states_[thread_idx];
+	currentPool = this;
+	currentWorker = thread_idx;
+
+	if (onWorkerStart_)
+		onWorkerStart_(thread_idx);
+
+	// Start of the current idle period, -1 while busy
+	int64_t idleSince = -1;
+	bool retired = false;
 
 	while (running_.load(std::memory_order_relaxed))
 	{
 		task_t task;
 
-		if (local_queue.try_dequeue(task))
+		if (takeRunNext(local, task))
+		{
+			// A task that keeps respawning itself must not starve the queue
+			if (local.runNextStreak < runNextLimit)
+			{
+				++local.runNextStreak;
+				trace::record(trace::event::resumeBegin);
+				task();
+				trace::record(trace::event::resumeEnd);
+				continue;
+			}
+			local_queue.enqueue(std::move(task));
+			task = nullptr;
+		}
+		local.runNextStreak = 0;
+
+		bool found = local_queue.try_dequeue(task);
+		if (!found)
+		{
+			static thread_local std::mt19937 generator(std::random_device {}());
+			std::uniform_int_distribution<size_t> distribution(0, capacity_ - 1);
+
+			for (size_t i = 0; i < capacity_ * 2; ++i)
+			{
+				size_t victim_idx = distribution(generator);
+				if (victim_idx == thread_idx)
+					continue;
+
+				if (queues_[victim_idx].try_dequeue(task) || stealRunNext(locals_[victim_idx], task))
+				{
+					trace::record(trace::event::steal, this, victim_idx);
+					found = true;
+					break;
+				}
+			}
+		}
+
+		if (found)
 		{
+			if (idleSince >= 0)
+			{
+				state.idleNs.fetch_add(static_cast<uint64_t>(sinceStart() - idleSince), std::memory_order_relaxed);
+				idleSince = -1;
+				trace::record(trace::event::unpark);
+			}
+			trace::record(trace::event::resumeBegin);
 			task();
+			trace::record(trace::event::resumeEnd);
 			continue;
 		}
 
-		static thread_local std::mt19937 generator(std::random_device {}());
-		std::uniform_int_distribution<size_t> distribution(0, workersCount_ - 1);
-
-		for (size_t i = 0; i < workersCount_ * 2; ++i)
+		int64_t now = sinceStart();
+		if (idleSince < 0)
 		{
-			size_t victim_idx = distribution(generator);
-			if (victim_idx == thread_idx)
-				continue;
+			idleSince = now;
+			trace::record(trace::event::park);
+		}
 
-			if (queues_[victim_idx].try_dequeue(task))
+		if (elastic_ && std::chrono::nanoseconds(now - idleSince) >= elasticConfig_.idleTimeout)
+		{
+			std::unique_lock<std::mutex> lock(statsMtx_);
+			size_t active = activeWorkers_.load();
+			while (active > elasticConfig_.minWorkers && !activeWorkers_.compare_exchange_weak(active, active - 1))
+			{ }
+			if (active > elasticConfig_.minWorkers)
 			{
-				task();
+				recordResize(active - 1, false);
+				retired = true;
 				break;
 			}
+			lock.unlock();
+			// Stay at minWorkers, restart the idle timer
+			state.idleNs.fetch_add(static_cast<uint64_t>(now - idleSince), std::memory_order_relaxed);
+			idleSince = now;
 		}
 	}
+
+	int64_t end = sinceStart();
+	if (idleSince >= 0)
+		state.idleNs.fetch_add(static_cast<uint64_t>(end - idleSince), std::memory_order_relaxed);
+	state.aliveNs.fetch_add(static_cast<uint64_t>(end - state.startedNs.load()), std::memory_order_relaxed);
+	state.active = false;
+
+	if (retired)
+	{
+		// Hand what is left to the running workers, pushes racing with this still reach stealers
+		task_t task;
+		if (takeRunNext(local, task))
+			queues_[pickQueue()].enqueue(std::move(task));
+		while (local_queue.try_dequeue(task))
+			queues_[pickQueue()].enqueue(std::move(task));
+	}
+
+	if (onWorkerStop_)
+		onWorkerStop_(thread_idx);
+
+	currentPool = nullptr;
 }
 
-} // namespace cs
\ No newline at end of file
+} // namespace cs
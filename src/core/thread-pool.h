@@ -1,11 +1,15 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
 #include <vector>
 #include <thread>
 #include <functional>
 
 #include "concurrentqueue.h" // Предполагается, что у вас есть потокобезопасная очередь
+#include "memory-accounting.h"
 
 namespace cs
 {
@@ -14,25 +18,148 @@ class threadPool
 {
 public:
 	using task_t = std::function<void()>;
+	using workerHook_t = std::function<void(size_t)>;
 
 	explicit threadPool(size_t workersCount);
 
 	void start();
 	void stop() noexcept;
 
+	// Called on every worker thread with its index right after it starts and right before it exits.
+	// Must be set before start().
+	void setWorkerHooks(workerHook_t onStart, workerHook_t onStop);
+
+	// Tasks pushed from one of this pool's workers go to that worker: the latest one into its run-next slot,
+	// the one it displaces to the worker's queue. Tasks pushed from other threads go to a random queue.
+	// A task left in the run-next slot for runNextGrace is stolen like a queued one, so a worker busy
+	// with a long task does not hold back the task it has just woken (a mutex handoff, for example).
 	void pushTask(task_t&& task);
 	void pushTask(const task_t& task);
 
+	// From one of this pool's workers: to the tail of that worker's queue, after the work pending there
+	// (which stays available to stealers). From other threads: same as pushTask.
+	void yieldTask(task_t&& task);
+
+	// To the queue of the given worker (modulo capacity), where it waits for that worker unless a stealer
+	// gets it first. From that worker itself: same as pushTask.
+	void pushTaskTo(size_t worker, task_t&& task);
+
+	static constexpr size_t npos = static_cast<size_t>(-1);
+	// Index of the calling thread among this pool's workers, npos for other threads
+	size_t currentWorkerIndex() const;
+
+	// Disables the worker-local path, every push goes to a random queue. Must be set before start().
+	void setLocalPush(bool enabled);
+
+	// Consecutive run-next tasks a worker runs before it serves its queue
+	static constexpr size_t runNextLimit = 16;
+	// How long a run-next task is left to its worker before stealers may take it
+	static constexpr std::chrono::microseconds runNextGrace { 5 };
+
+	// Elastic mode: the pool starts workersCount workers clamped to [minWorkers, maxWorkers], adds one
+	// whenever work stays queued for growAfter and retires a worker idle for idleTimeout while more than
+	// minWorkers run. Queues for maxWorkers are allocated up front, so stealers and pushers never see
+	// the array change, and worker indices stay below maxWorkers. Must be set before start().
+	struct elasticConfig
+	{
+		size_t minWorkers;
+		size_t maxWorkers;
+		std::chrono::milliseconds idleTimeout { 100 };
+		std::chrono::milliseconds growAfter { 1 };
+	};
+
+	void setElastic(const elasticConfig& config);
+
+	struct resizeEvent
+	{
+		std::chrono::nanoseconds at; // since start()
+		size_t workers;              // after the resize
+	};
+
+	struct stats
+	{
+		size_t workers;
+		size_t peakWorkers;
+		size_t grows;
+		size_t shrinks;
+		double utilization; // share of workers' lifetime spent running tasks
+		std::vector<resizeEvent> events;
+	};
+
+	stats getStats() const;
+	// Workers currently running
+	size_t workersCount() const;
+	// Upper bound of worker indices
+	size_t capacity() const;
+
 	std::atomic<bool>& running() { return running_; }
 
 private:
 	void worker(size_t thread_idx);
+	void monitor();
+	void spawnWorker(size_t thread_idx);
+	// Random running worker's queue, for pushes from outside and tasks left by a retiring worker
+	size_t pickQueue();
+	// With statsMtx_ held since the activeWorkers_ change it records, so getStats sees both or neither
+	void recordResize(size_t workers, bool grow);
+	int64_t sinceStart() const;
+
+	struct workerLocal;
+	// Moves the run-next task out of the slot, false if it is empty or another thread is taking it
+	static bool takeRunNext(workerLocal& local, task_t& task);
+	// Same, for other workers: only once the task has waited there for runNextGrace
+	bool stealRunNext(workerLocal& local, task_t& task);
 
 
 	size_t workersCount_;
+	size_t capacity_;
 	std::atomic<bool> running_ { false };
 	std::vector<std::thread> workers_;
-	std::vector<moodycamel::ConcurrentQueue<task_t>> queues_;
+	std::vector<accountedQueue<task_t>> queues_;
+
+	struct alignas(64) workerState
+	{
+		std::atomic<bool> active { false };
+		std::atomic<int64_t> startedNs { 0 };
+		std::atomic<uint64_t> aliveNs { 0 };
+		std::atomic<uint64_t> idleNs { 0 };
+	};
+
+	std::vector<workerState> states_;
+	std::atomic<size_t> activeWorkers_ { 0 };
+
+	bool elastic_ { false };
+	elasticConfig elasticConfig_ { 0, 0 };
+	std::thread monitor_;
+	std::chrono::steady_clock::time_point startTime_;
+
+	mutable std::mutex statsMtx_;
+	std::vector<resizeEvent> events_;
+	size_t peakWorkers_ { 0 };
+	size_t grows_ { 0 };
+	size_t shrinks_ { 0 };
+
+	enum slotState : uint8_t
+	{
+		runNextEmpty,
+		runNextFull,
+		runNextTaking
+	};
+
+	// Only the owning worker fills the slot (empty -> full), the owner or a stealer takes the task out
+	// (full -> taking -> empty)
+	struct alignas(64) workerLocal
+	{
+		std::atomic<uint8_t> runNextState { runNextEmpty };
+		std::atomic<int64_t> runNextSinceNs { 0 };
+		task_t runNext;
+		size_t runNextStreak { 0 }; // owner only
+	};
+
+	std::vector<workerLocal> locals_;
+	bool localPush_ { true };
+	workerHook_t onWorkerStart_;
+	workerHook_t onWorkerStop_;
 };
 
 } // namespace cs
\ No newline at end of file
@@ -0,0 +1,208 @@
+#include "trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <ios>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace cs
+{
+namespace
+{
+struct entry
+{
+	uint64_t tsc;
+	const void* object;
+	uint64_t arg;
+	trace::event type;
+};
+
+// Written by its thread only, read by writeChrome
+struct ring
+{
+	explicit ring(size_t index)
+	: entries(std::make_unique<entry[]>(trace::ringCapacity))
+	, thread(index)
+	{ }
+
+	std::unique_ptr<entry[]> entries;
+	std::atomic<uint64_t> written { 0 };
+	size_t thread;
+};
+
+// Rings outlive their threads, so events of finished workers are still exported
+struct registry
+{
+	std::mutex mtx;
+	std::vector<std::unique_ptr<ring>> rings;
+	uint64_t startTsc = 0;
+	std::chrono::steady_clock::time_point startTime;
+};
+
+registry& rings()
+{
+	static registry instance;
+	return instance;
+}
+
+thread_local ring* currentRing = nullptr;
+
+uint64_t readTsc()
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+const char* eventName(trace::event type)
+{
+	switch (type)
+	{
+	case trace::event::resumeBegin:
+	case trace::event::resumeEnd:
+		return "resume";
+	case trace::event::steal:
+		return "steal";
+	case trace::event::park:
+	case trace::event::unpark:
+		return "idle";
+	case trace::event::lockRequest:
+		return "lock request";
+	case trace::event::lockAcquire:
+	case trace::event::lockRelease:
+		return "held";
+	case trace::event::handoff:
+		return "handoff";
+	}
+	return "unknown";
+}
+
+void writeEvent(std::ostream& out, const entry& e, size_t thread, double us)
+{
+	out << "{\"name\":\"" << eventName(e.type) << "\",\"pid\":1,\"tid\":" << thread << ",\"ts\":" << us;
+	switch (e.type)
+	{
+	case trace::event::resumeBegin:
+	case trace::event::park:
+		out << ",\"ph\":\"B\"}";
+		return;
+	case trace::event::resumeEnd:
+	case trace::event::unpark:
+		out << ",\"ph\":\"E\"}";
+		return;
+	case trace::event::lockAcquire:
+	case trace::event::lockRelease:
+		// Async slice per mutex: hold periods line up across threads
+		out << ",\"ph\":\"" << (e.type == trace::event::lockAcquire ? 'b' : 'e') << "\",\"cat\":\"lock\",\"id\":\"" << e.object << "\"}";
+		return;
+	case trace::event::steal:
+		out << ",\"ph\":\"i\",\"s\":\"t\",\"args\":{\"victim\":" << e.arg << "}}";
+		return;
+	default:
+		out << ",\"ph\":\"i\",\"s\":\"t\",\"args\":{\"mutex\":\"" << e.object << "\"}}";
+		return;
+	}
+}
+} // namespace
+
+void trace::enable(bool enabled)
+{
+	if constexpr (!compiled)
+		return;
+
+	if (enabled && !enabled_.load())
+	{
+		auto& reg = rings();
+		std::lock_guard<std::mutex> lock(reg.mtx);
+		reg.startTime = std::chrono::steady_clock::now();
+		reg.startTsc = readTsc();
+	}
+	enabled_.store(enabled);
+}
+
+bool trace::enabled()
+{
+	return enabled_.load();
+}
+
+void trace::append(event type, const void* object, uint64_t arg) noexcept
+{
+	ring* r = currentRing;
+	if (r == nullptr)
+	{
+		auto& reg = rings();
+		std::lock_guard<std::mutex> lock(reg.mtx);
+		reg.rings.push_back(std::make_unique<ring>(reg.rings.size()));
+		r = currentRing = reg.rings.back().get();
+	}
+
+	uint64_t n = r->written.load(std::memory_order_relaxed);
+	r->entries[n % ringCapacity] = entry { readTsc(), object, arg, type };
+	r->written.store(n + 1, std::memory_order_release);
+}
+
+bool trace::writeChrome(std::ostream& out)
+{
+	if constexpr (!compiled)
+		return false;
+
+	auto& reg = rings();
+	std::lock_guard<std::mutex> lock(reg.mtx);
+
+	// TSC ticks per microsecond, measured over the whole recording
+	auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - reg.startTime).count();
+	double ticksPerUs = 1000.0;
+	uint64_t ticks = readTsc() - reg.startTsc;
+	if (elapsed > 0.0 && ticks != 0)
+		ticksPerUs = static_cast<double>(ticks) / elapsed;
+
+	auto flags = out.flags();
+	auto precision = out.precision();
+	out << std::fixed << std::setprecision(3);
+
+	out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+	bool first = true;
+	for (const auto& r : reg.rings)
+	{
+		if (!first)
+			out << ",";
+		first = false;
+		out << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << r->thread << ",\"args\":{\"name\":\"thread " << r->thread << "\"}}";
+
+		uint64_t written = r->written.load(std::memory_order_acquire);
+		uint64_t begin = written - std::min<uint64_t>(written, ringCapacity);
+		for (uint64_t i = begin; i < written; ++i)
+		{
+			const entry& e = r->entries[i % ringCapacity];
+			// Recorded before the last enable
+			if (e.tsc < reg.startTsc)
+				continue;
+			out << ",\n";
+			writeEvent(out, e, r->thread, static_cast<double>(e.tsc - reg.startTsc) / ticksPerUs);
+		}
+	}
+	out << "\n]}\n";
+
+	out.flags(flags);
+	out.precision(precision);
+	return true;
+}
+
+void trace::clear()
+{
+	auto& reg = rings();
+	std::lock_guard<std::mutex> lock(reg.mtx);
+	for (auto& r : reg.rings)
+		r->written.store(0);
+}
+} // namespace cs
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+
+namespace cs
+{
+// Timeline of scheduling and lock events, exported as Chrome trace event JSON (chrome://tracing, ui.perfetto.dev).
+// Every thread appends to its own fixed ring, the oldest events are overwritten, timestamps are raw TSC.
+// Only built with -DBUILD_TRACE=ON (CS_TRACE defined): otherwise record() is empty and no ring is ever allocated.
+class trace
+{
+public:
+#ifdef CS_TRACE
+	static constexpr bool compiled = true;
+#else
+	static constexpr bool compiled = false;
+#endif
+
+	// Events per thread kept in the ring
+	static constexpr size_t ringCapacity = size_t { 1 } << 16;
+
+	enum class event : uint8_t
+	{
+		resumeBegin,
+		resumeEnd,
+		steal, // arg - victim worker
+		park,
+		unpark,
+		lockRequest, // object - the mutex
+		lockAcquire,
+		lockRelease,
+		handoff,
+	};
+
+	static void enable(bool enabled);
+	static bool enabled();
+
+	static void record(event type, const void* object = nullptr, uint64_t arg = 0) noexcept
+	{
+		if constexpr (compiled)
+		{
+			if (enabled_.load(std::memory_order_relaxed))
+				append(type, object, arg);
+		}
+	}
+
+	// Writes what the rings hold, call once the recording threads are stopped.
+	// Returns false when built without tracing
+	static bool writeChrome(std::ostream& out);
+
+	// Drops the recorded events, the rings stay allocated
+	static void clear();
+
+private:
+	static void append(event type, const void* object, uint64_t arg) noexcept;
+
+	static inline std::atomic<bool> enabled_ { false };
+};
+} // namespace cs
@@ -0,0 +1,227 @@
+#include <gtest/gtest.h>
+
+#include "core/async-generator.h"
+#include "core/coro-mutex.h"
+#include "core/strand-executor.h"
+#include "core/task.h"
+
+#include "wait-for.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace cs;
+
+namespace
+{
+// Runs a consumer coroutine that never suspends on anything but the generator inline
+void runInline(task t)
+{
+	t.resume();
+	ASSERT_TRUE(t.done());
+	t.handle().destroy();
+}
+
+async_generator<int> range(int count)
+{
+	for (int i = 0; i < count; ++i)
+		co_yield i;
+}
+} // namespace
+
+TEST(AsyncGeneratorTest, YieldsSequence)
+{
+	std::vector<int> values;
+
+	auto consumer = [&]() -> task
+	{
+		auto gen = range(5);
+		while (int* value = co_await gen.next())
+			values.push_back(*value);
+		EXPECT_TRUE(gen.done());
+		EXPECT_EQ(co_await gen.next(), nullptr);
+	};
+
+	runInline(consumer());
+	EXPECT_EQ(values, (std::vector<int> { 0, 1, 2, 3, 4 }));
+}
+
+TEST(AsyncGeneratorTest, YieldedValueIsNotCopied)
+{
+	const int* produced = nullptr;
+	const int* consumed = nullptr;
+	std::unique_ptr<int> moved;
+
+	auto producer = [&]() -> async_generator<std::unique_ptr<int>>
+	{
+		auto value = std::make_unique<int>(7);
+		produced = value.get();
+		co_yield value;
+	};
+
+	auto consumer = [&]() -> task
+	{
+		auto gen = producer();
+		auto* value = co_await gen.next();
+		consumed = value->get();
+		moved = std::move(*value);
+		EXPECT_EQ(co_await gen.next(), nullptr);
+	};
+
+	runInline(consumer());
+	EXPECT_EQ(produced, consumed);
+	ASSERT_TRUE(moved);
+	EXPECT_EQ(*moved, 7);
+}
+
+TEST(AsyncGeneratorTest, ConstLvalueIsCopied)
+{
+	const std::vector<int> source { 1, 2, 3 };
+	const std::vector<int>* consumed = nullptr;
+	std::vector<int> moved;
+
+	auto producer = [&]() -> async_generator<std::vector<int>>
+	{
+		co_yield source;
+	};
+
+	auto consumer = [&]() -> task
+	{
+		auto gen = producer();
+		auto* value = co_await gen.next();
+		consumed = value;
+		moved = std::move(*value);
+		EXPECT_EQ(co_await gen.next(), nullptr);
+	};
+
+	runInline(consumer());
+	EXPECT_NE(consumed, &source);
+	EXPECT_EQ(moved, source);
+	EXPECT_EQ(source, (std::vector<int> { 1, 2, 3 }));
+}
+
+TEST(AsyncGeneratorTest, ConstValueTypeYieldsConstLvalue)
+{
+	const int source = 5;
+	const int* consumed = nullptr;
+
+	auto producer = [&]() -> async_generator<const int>
+	{
+		co_yield source;
+	};
+
+	auto consumer = [&]() -> task
+	{
+		auto gen = producer();
+		consumed = co_await gen.next();
+		EXPECT_EQ(co_await gen.next(), nullptr);
+	};
+
+	runInline(consumer());
+	EXPECT_EQ(consumed, &source);
+}
+
+TEST(AsyncGeneratorTest, EarlyStopDestroysProducerFrame)
+{
+	struct guard
+	{
+		bool& destroyed;
+		~guard() { destroyed = true; }
+	};
+
+	bool destroyed = false;
+	int produced = 0;
+
+	auto producer = [&]() -> async_generator<int>
+	{
+		guard g { destroyed };
+		for (int i = 0;; ++i)
+		{
+			++produced;
+			co_yield i;
+		}
+	};
+
+	auto consumer = [&]() -> task
+	{
+		auto gen = producer();
+		for (int i = 0; i < 3; ++i)
+			co_await gen.next();
+		EXPECT_FALSE(destroyed);
+	};
+
+	runInline(consumer());
+	EXPECT_TRUE(destroyed);
+	EXPECT_EQ(produced, 3);
+}
+
+TEST(AsyncGeneratorTest, ExceptionIsRethrownInConsumer)
+{
+	bool caught = false;
+	std::vector<int> values;
+
+	auto producer = []() -> async_generator<int>
+	{
+		co_yield 1;
+		throw std::runtime_error("boom");
+	};
+
+	auto consumer = [&]() -> task
+	{
+		auto gen = producer();
+		try
+		{
+			while (int* value = co_await gen.next())
+				values.push_back(*value);
+		}
+		catch (const std::runtime_error&)
+		{
+			caught = true;
+		}
+	};
+
+	runInline(consumer());
+	EXPECT_TRUE(caught);
+	EXPECT_EQ(values, std::vector<int> { 1 });
+}
+
+TEST(AsyncGeneratorTest, ProducerAwaitsCoroMutex)
+{
+	strandExecutor strand;
+	coroMutex mtx;
+	mtx.lock();
+	std::atomic<bool> completed = false;
+	std::vector<int> values;
+
+	auto producer = [&]() -> async_generator<int>
+	{
+		for (int i = 0; i < 3; ++i)
+		{
+			co_await mtx.lock();
+			mtx.unlock();
+			co_yield i;
+		}
+	};
+
+	auto consumer = [&]() -> task
+	{
+		auto gen = producer();
+		while (int* value = co_await gen.next())
+			values.push_back(*value);
+		completed = true;
+	};
+
+	strand.execute(consumer());
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	EXPECT_FALSE(completed);
+	EXPECT_TRUE(values.empty());
+
+	// The producer waits on the mutex and is resumed on the strand
+	mtx.unlock();
+	waitFor(completed);
+	EXPECT_EQ(values, (std::vector<int> { 0, 1, 2 }));
+}
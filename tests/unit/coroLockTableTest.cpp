@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+
+#include "core/coro-lock-table.h"
+#include "core/pool-executor.h"
+#include "core/strand-executor.h"
+
+#include "wait-for.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace cs;
+
+namespace
+{
+// Keys of two different stripes
+std::pair<size_t, size_t> keysOnDifferentStripes(const coroLockTable& table)
+{
+	for (size_t key = 1;; ++key)
+	{
+		if (table.stripeOf(key) != table.stripeOf(0))
+			return { 0, key };
+	}
+}
+} // namespace
+
+TEST(CoroLockTableTest, StripesAreRoundedAndMemoryIsFlat)
+{
+	coroLockTable table(1000);
+	EXPECT_EQ(table.stripesCount(), 1024u);
+
+	size_t before = table.memoryUsage();
+	for (size_t key = 0; key < 100000; ++key)
+		EXPECT_LT(table.stripeOf(key), table.stripesCount());
+	EXPECT_EQ(table.memoryUsage(), before);
+}
+
+TEST(CoroLockTableTest, LockAndUnlockKey)
+{
+	coroLockTable table(16);
+	bool completed = false;
+
+	auto coro = [&]() -> task
+	{
+		co_await table.lock(42);
+		EXPECT_TRUE(table.locked(42));
+		table.unlock(42);
+		completed = true;
+	};
+
+	auto t = coro();
+	t.resume();
+	EXPECT_TRUE(completed);
+	EXPECT_FALSE(table.locked(42));
+	t.handle().destroy();
+}
+
+TEST(CoroLockTableTest, OtherStripeDoesNotWait)
+{
+	coroLockTable table(64);
+	auto [held, other] = keysOnDifferentStripes(table);
+	bool completed = false;
+
+	auto coro = [&]() -> task
+	{
+		co_await table.lock(other);
+		table.unlock(other);
+		completed = true;
+	};
+
+	auto holder = table.lock(held);
+	ASSERT_TRUE(holder.await_ready());
+	auto t = coro();
+	t.resume();
+	EXPECT_TRUE(completed);
+	table.unlock(held);
+	t.handle().destroy();
+}
+
+TEST(CoroLockTableTest, WaiterResumesOnOriginExecutor)
+{
+	strandExecutor strand;
+	coroLockTable table(8);
+	ASSERT_TRUE(table.lock(7).await_ready());
+	std::atomic<bool> waiting = false;
+	std::atomic<bool> completed = false;
+	executor* resumedOn = nullptr;
+
+	auto coro = [&]() -> task
+	{
+		waiting = true;
+		co_await table.lock(7);
+		resumedOn = &executor::current();
+		table.unlock(7);
+		completed = true;
+	};
+
+	strand.execute(coro());
+	waitFor(waiting);
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	EXPECT_FALSE(completed);
+
+	table.unlock(7);
+	waitFor(completed);
+	EXPECT_EQ(resumedOn, &strand);
+	EXPECT_FALSE(table.locked(7));
+}
+
+TEST(CoroLockTableTest, NoRaceConditionPerKey)
+{
+	auto tp = std::make_shared<threadPool>(4);
+	auto pool = std::make_shared<poolExecutor>(tp);
+	tp->start();
+
+	// Fewer stripes than keys, so keys also collide on stripes
+	coroLockTable table(4);
+	constexpr size_t keys = 16;
+	constexpr int coroCount = 32;
+	constexpr int iterations = 1000;
+	std::vector<int> counters(keys);
+	std::atomic<int> completed = 0;
+	std::atomic<bool> done = false;
+
+	auto coro = [&](size_t key) -> task
+	{
+		for (int i = 0; i < iterations; ++i)
+		{
+			co_await table.lock(key);
+			++counters[key];
+			table.unlock(key);
+			co_await yield();
+		}
+		if (completed.fetch_add(1) + 1 == coroCount)
+			done = true;
+	};
+
+	for (int i = 0; i < coroCount; ++i)
+		pool->execute(coro(static_cast<size_t>(i) % keys));
+	waitFor(done, 5000);
+
+	for (size_t key = 0; key < keys; ++key)
+		EXPECT_EQ(counters[key], coroCount / static_cast<int>(keys) * iterations);
+	tp->stop();
+}
@@ -6,6 +6,7 @@
 #include <atomic>
 #include <thread>
 #include <chrono>
+#include <stdexcept>
 
 using namespace cs;
 
@@ -52,6 +53,38 @@ TEST(CoroMutexTest, AwaiterNotReadyForSubsequentLocks)
 	mtx.unlock();
 }
 
+TEST(CoroMutexTest, UnlockBeforeSuspendHandsLockToWaiter)
+{
+	coroMutex mtx;
+	[[maybe_unused]] auto holder = mtx.lock();
+	auto waiter = mtx.lock();
+	EXPECT_FALSE(waiter.await_ready());
+
+	// Released between the waiter's await_ready and await_suspend: the waiter takes the mutex
+	// instead of queueing behind a holder that is gone
+	mtx.unlock();
+	EXPECT_FALSE(waiter.await_suspend(std::noop_coroutine()));
+	EXPECT_TRUE(mtx.locked());
+
+	mtx.unlock();
+	EXPECT_FALSE(mtx.locked());
+}
+
+TEST(CoroMutexTest, UncontendedRunExecutesInline)
+{
+	coroMutex mtx;
+	int result = 0;
+
+	auto coro = [&]() -> task { result = co_await mtx.run([]() { return 5; }); };
+
+	auto t = coro();
+	t.resume();
+	EXPECT_TRUE(t.done());
+	EXPECT_EQ(result, 5);
+	EXPECT_FALSE(mtx.locked());
+	t.handle().destroy();
+}
+
 // Тесты однопоточного асинхронного поведения
 class CoroMutexSingleThreadTest : public ::testing::Test
 {
@@ -137,6 +170,62 @@ TEST_F(CoroMutexSingleThreadTest, RecursiveLockBlocks)
 	waitForCompletion(secondLockObtained);
 }
 
+TEST_F(CoroMutexSingleThreadTest, RunIsExecutedByReleasingHolder)
+{
+	coroMutex mtx;
+	[[maybe_unused]] auto holder = mtx.lock();
+	std::atomic<bool> completed = false;
+	std::thread::id ranOn;
+	int result = 0;
+
+	auto coro = [&]() -> task
+	{
+		result = co_await mtx.run(
+			[&]()
+			{
+				ranOn = std::this_thread::get_id();
+				return 7;
+			});
+		completed = true;
+	};
+
+	taskManager::instance().execute(coro());
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	EXPECT_FALSE(completed);
+
+	// The closure runs right here, the coroutine is resumed on the pool
+	mtx.unlock();
+	EXPECT_EQ(ranOn, std::this_thread::get_id());
+	waitForCompletion(completed);
+	EXPECT_EQ(result, 7);
+	EXPECT_FALSE(mtx.locked());
+}
+
+TEST_F(CoroMutexSingleThreadTest, RunRethrowsException)
+{
+	coroMutex mtx;
+	std::atomic<bool> completed = false;
+	bool caught = false;
+
+	auto coro = [&]() -> task
+	{
+		try
+		{
+			co_await mtx.run([]() { throw std::runtime_error("boom"); });
+		}
+		catch (const std::runtime_error&)
+		{
+			caught = true;
+		}
+		completed = true;
+	};
+
+	taskManager::instance().execute(coro());
+	waitForCompletion(completed);
+	EXPECT_TRUE(caught);
+	EXPECT_FALSE(mtx.locked());
+}
+
 // Тесты многопоточного поведения
 class CoroMutexMultiThreadTest : public ::testing::Test
 {
@@ -192,6 +281,39 @@ TEST_F(CoroMutexMultiThreadTest, NoRaceCondition)
 	EXPECT_EQ(counter, iterations * coroCount);
 }
 
+// unlock() racing with a coroutine that found the mutex taken and has not queued itself yet must hand the
+// lock over instead of releasing it, otherwise that coroutine is never resumed and the test times out
+TEST_F(CoroMutexMultiThreadTest, ContendedUnlockDoesNotLoseWaiters)
+{
+	coroMutex mtx;
+	int counter = 0;
+	constexpr int iterations = 2000;
+	constexpr int coroCount = 64;
+	std::atomic<int> completed = 0;
+
+	auto coro = [&]() -> task
+	{
+		for (int i = 0; i < iterations; ++i)
+		{
+			co_await mtx.lock();
+			++counter;
+			mtx.unlock();
+			// Back through the pool, so the coroutines keep arriving at lock() from every worker
+			co_await yield();
+		}
+		completed++;
+	};
+
+	for (int i = 0; i < coroCount; ++i)
+	{
+		taskManager::instance().execute(coro());
+	}
+
+	waitForAtomic(completed, coroCount, 10000);
+	EXPECT_EQ(counter, iterations * coroCount);
+	EXPECT_FALSE(mtx.locked());
+}
+
 TEST_F(CoroMutexMultiThreadTest, FIFOOrdering)
 {
 	coroMutex mtx;
@@ -229,4 +351,42 @@ TEST_F(CoroMutexMultiThreadTest, FIFOOrdering)
 	{
 		EXPECT_EQ(lockOrder[i], unlockOrder[i]) << "Execution should be FIFO";
 	}
-}
\ No newline at end of file
+}
+TEST_F(CoroMutexMultiThreadTest, RunAndLockNoRaceCondition)
+{
+	coroMutex mtx;
+	int counter = 0;
+	constexpr int iterations = 5000;
+	constexpr int coroCount = 10;
+	std::atomic<int> completed = 0;
+
+	auto runCoro = [&]() -> task
+	{
+		for (int i = 0; i < iterations; ++i)
+			co_await mtx.run([&]() { ++counter; });
+		completed++;
+	};
+
+	auto lockCoro = [&]() -> task
+	{
+		for (int i = 0; i < iterations; ++i)
+		{
+			co_await mtx.lock();
+			++counter;
+			mtx.unlock();
+		}
+		completed++;
+	};
+
+	for (int i = 0; i < coroCount; ++i)
+	{
+		if (i % 2 == 0)
+			taskManager::instance().execute(runCoro());
+		else
+			taskManager::instance().execute(lockCoro());
+	}
+
+	waitForAtomic(completed, coroCount, 5000);
+	EXPECT_EQ(counter, iterations * coroCount);
+	EXPECT_FALSE(mtx.locked());
+}
@@ -0,0 +1,273 @@
+#include <gtest/gtest.h>
+
+#include "core/coro-mutex.h"
+#include "core/inline-executor.h"
+#include "core/pool-executor.h"
+#include "core/strand-executor.h"
+#include "core/task-manager.h"
+
+#include "wait-for.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace cs;
+
+TEST(ExecutorTest, InlineExecutorResumesImmediately)
+{
+	inlineExecutor exec;
+	bool completed = false;
+	executor* runningOn = nullptr;
+
+	auto coro = [&]() -> task
+	{
+		runningOn = &executor::current();
+		completed = true;
+		co_return;
+	};
+
+	exec.execute(coro());
+	EXPECT_TRUE(completed);
+	EXPECT_EQ(runningOn, &exec);
+}
+
+TEST(ExecutorTest, CurrentOutsideExecutorIsTaskManager)
+{
+	EXPECT_EQ(&executor::current(), &taskManager::instance());
+}
+
+TEST(ExecutorTest, ScheduleOnMovesToStrandThread)
+{
+	inlineExecutor start;
+	strandExecutor strand;
+	std::atomic<bool> completed = false;
+	std::thread::id before;
+	std::thread::id after;
+	executor* runningOn = nullptr;
+
+	auto coro = [&]() -> task
+	{
+		before = std::this_thread::get_id();
+		co_await schedule_on(strand);
+		after = std::this_thread::get_id();
+		runningOn = &executor::current();
+		completed = true;
+	};
+
+	start.execute(coro());
+	waitFor(completed);
+	EXPECT_EQ(before, std::this_thread::get_id());
+	EXPECT_NE(after, std::this_thread::get_id());
+	EXPECT_EQ(runningOn, &strand);
+}
+
+TEST(ExecutorTest, StrandRunsCoroutinesSequentially)
+{
+	strandExecutor strand;
+	std::atomic<int> inside = 0;
+	std::atomic<bool> overlapped = false;
+	std::atomic<int> completed = 0;
+	constexpr int coroCount = 20;
+
+	auto coro = [&]() -> task
+	{
+		for (int i = 0; i < 100; ++i)
+		{
+			if (inside.fetch_add(1) != 0)
+				overlapped = true;
+			inside.fetch_sub(1);
+			co_await yield();
+		}
+		completed++;
+	};
+
+	for (int i = 0; i < coroCount; ++i)
+		strand.execute(coro());
+
+	std::atomic<bool> done = false;
+	std::thread waiter(
+		[&]()
+		{
+			while (completed.load() != coroCount)
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			done = true;
+		});
+	waitFor(done, 5000);
+	waiter.join();
+	EXPECT_FALSE(overlapped);
+}
+
+TEST(ExecutorTest, YieldRunsPendingWorkFirst)
+{
+	strandExecutor strand;
+	std::vector<int> order;
+	std::atomic<bool> completed = false;
+
+	auto other = [&]() -> task
+	{
+		order.push_back(1);
+		co_return;
+	};
+
+	auto yielding = [&]() -> task
+	{
+		executor::current().execute(other());
+		co_await yield();
+		order.push_back(2);
+		completed = true;
+	};
+
+	strand.execute(yielding());
+	waitFor(completed);
+	ASSERT_EQ(order.size(), 2u);
+	EXPECT_EQ(order[0], 1);
+	EXPECT_EQ(order[1], 2);
+}
+
+TEST(ExecutorTest, ExhaustedBudgetYieldsOnUncontendedLock)
+{
+	strandExecutor strand;
+	strand.setBudget(2);
+	coroMutex mtx;
+	std::vector<char> order;
+	std::atomic<bool> completed = false;
+
+	auto other = [&]() -> task
+	{
+		order.push_back('B');
+		co_return;
+	};
+
+	auto locking = [&]() -> task
+	{
+		executor::current().execute(other());
+		for (int i = 0; i < 4; ++i)
+		{
+			co_await mtx.lock();
+			order.push_back('A');
+			mtx.unlock();
+		}
+		completed = true;
+	};
+
+	strand.execute(locking());
+	waitFor(completed);
+	EXPECT_EQ(std::string(order.begin(), order.end()), "AABAA");
+	EXPECT_FALSE(mtx.locked());
+}
+
+TEST(ExecutorTest, TaskManagerBudgetAppliesToInitializedExecutor)
+{
+	auto& manager = taskManager::instance();
+	manager.setBudget(3);
+
+	auto strand = std::make_shared<strandExecutor>();
+	manager.init(std::static_pointer_cast<executor>(strand));
+	EXPECT_EQ(strand->budget(), 3u);
+
+	manager.setBudget(0);
+}
+
+TEST(ExecutorTest, CoroMutexWaiterResumesOnOriginExecutor)
+{
+	auto tp = std::make_shared<threadPool>(2);
+	auto pool = std::make_shared<poolExecutor>(tp);
+	tp->start();
+	strandExecutor strand;
+
+	coroMutex mtx;
+	mtx.lock();
+	std::atomic<bool> waiting = false;
+	std::atomic<bool> completed = false;
+	executor* resumedOn = nullptr;
+
+	auto waiterCoro = [&]() -> task
+	{
+		waiting = true;
+		co_await mtx.lock();
+		resumedOn = &executor::current();
+		mtx.unlock();
+		completed = true;
+	};
+
+	auto unlockerCoro = [&]() -> task
+	{
+		mtx.unlock();
+		co_return;
+	};
+
+	strand.execute(waiterCoro());
+	waitFor(waiting);
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	pool->execute(unlockerCoro());
+
+	waitFor(completed);
+	EXPECT_EQ(resumedOn, &strand);
+	tp->stop();
+}
+
+TEST(ExecutorTest, CoroMutexLearnsHomeFromFirstRelease)
+{
+	auto tp = std::make_shared<threadPool>(4);
+	auto pool = std::make_shared<poolExecutor>(tp);
+	tp->start();
+
+	coroMutex mtx;
+	mtx.learnAffinity();
+	std::atomic<bool> completed = false;
+	size_t releasedOn = executor::noAffinity;
+
+	auto coro = [&]() -> task
+	{
+		co_await mtx.lock();
+		releasedOn = executor::current().affinity();
+		mtx.unlock();
+		completed = true;
+	};
+
+	EXPECT_EQ(mtx.affinity(), executor::noAffinity);
+	pool->execute(coro());
+	waitFor(completed);
+	EXPECT_NE(releasedOn, executor::noAffinity);
+	EXPECT_EQ(mtx.affinity(), releasedOn);
+	tp->stop();
+}
+
+TEST(ExecutorTest, CoroMutexAffinityKeepsMutualExclusion)
+{
+	auto tp = std::make_shared<threadPool>(4);
+	auto pool = std::make_shared<poolExecutor>(tp);
+	tp->start();
+
+	coroMutex mtx;
+	mtx.setAffinity(1);
+	constexpr int coroCount = 8;
+	constexpr int iterations = 500;
+	int shared = 0;
+	std::atomic<int> completed = 0;
+	std::atomic<bool> done = false;
+
+	auto coro = [&]() -> task
+	{
+		for (int i = 0; i < iterations; ++i)
+		{
+			co_await mtx.lock();
+			++shared;
+			mtx.unlock();
+			co_await yield();
+		}
+		if (completed.fetch_add(1) + 1 == coroCount)
+			done = true;
+	};
+
+	for (int i = 0; i < coroCount; ++i)
+		pool->execute(coro());
+	waitFor(done, 5000);
+	EXPECT_EQ(shared, coroCount * iterations);
+	EXPECT_FALSE(mtx.locked());
+	tp->stop();
+}
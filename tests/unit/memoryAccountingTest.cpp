@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+
+#include "core/memory-accounting.h"
+#include "core/task.h"
+
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace cs;
+
+namespace
+{
+class MemoryAccountingTest : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		if (!memoryAccounting::compiled)
+			GTEST_SKIP() << "built without BUILD_MEMORY_ACCOUNTING";
+		memoryAccounting::enable(true);
+	}
+	void TearDown() override { memoryAccounting::enable(false); }
+};
+
+task suspended(int64_t value)
+{
+	volatile int64_t local = value;
+	(void)local;
+	co_return;
+}
+} // namespace
+
+TEST_F(MemoryAccountingTest, SuspendedTasksAreCounted)
+{
+	constexpr size_t count = 1000;
+	auto before = memoryAccounting::take();
+
+	std::vector<task> tasks;
+	tasks.reserve(count);
+	for (size_t i = 0; i < count; ++i)
+		tasks.push_back(suspended(static_cast<int64_t>(i)));
+
+	auto during = memoryAccounting::take();
+	EXPECT_EQ(during.liveFrames - before.liveFrames, count);
+	EXPECT_EQ(during.totalFrames - before.totalFrames, count);
+	EXPECT_GE(during.peakLiveFrames, during.liveFrames);
+	uint64_t bytes = during.frameBytes - before.frameBytes;
+	EXPECT_GT(bytes, 0u);
+	EXPECT_EQ(bytes % count, 0u);
+
+	uint64_t bySize = 0;
+	for (size_t i = 0; i < memoryAccounting::frameSizeClasses; ++i)
+		bySize += during.frameBytesBySize[i] - before.frameBytesBySize[i];
+	EXPECT_EQ(bySize, bytes);
+
+	for (auto& t : tasks)
+		t.handle().destroy();
+
+	auto after = memoryAccounting::take();
+	EXPECT_EQ(after.liveFrames, before.liveFrames);
+	EXPECT_EQ(after.frameBytes, before.frameBytes);
+	EXPECT_GE(after.peakLiveFrames + memoryAccounting::peakLagFrames, before.liveFrames + count);
+}
+
+TEST_F(MemoryAccountingTest, FramesAreReleasedWithTheSettingOfTheirAllocation)
+{
+	constexpr size_t count = 100;
+	auto before = memoryAccounting::take();
+
+	std::vector<task> counted;
+	for (size_t i = 0; i < count; ++i)
+		counted.push_back(suspended(static_cast<int64_t>(i)));
+
+	memoryAccounting::enable(false);
+	std::vector<task> uncounted;
+	for (size_t i = 0; i < count; ++i)
+		uncounted.push_back(suspended(static_cast<int64_t>(i)));
+	// Counted frames freed while disabled are still uncounted
+	for (auto& t : counted)
+		t.handle().destroy();
+
+	memoryAccounting::enable(true);
+	auto during = memoryAccounting::take();
+	EXPECT_EQ(during.liveFrames, before.liveFrames);
+	EXPECT_EQ(during.frameBytes, before.frameBytes);
+
+	// Uncounted frames freed while enabled leave the counters alone
+	for (auto& t : uncounted)
+		t.handle().destroy();
+	auto after = memoryAccounting::take();
+	EXPECT_EQ(after.liveFrames, before.liveFrames);
+	EXPECT_EQ(after.frameBytes, before.frameBytes);
+	EXPECT_EQ(after.totalFrames - before.totalFrames, count);
+}
+
+TEST_F(MemoryAccountingTest, QueueBlocksAreCounted)
+{
+	auto before = memoryAccounting::take();
+	{
+		auto queue = std::make_unique<accountedQueue<int>>();
+		for (int i = 0; i < 1000; ++i)
+			queue->enqueue(i);
+
+		auto during = memoryAccounting::take();
+		EXPECT_GT(during.queueBlocks, before.queueBlocks);
+		EXPECT_GT(during.queueBytes, before.queueBytes);
+	}
+	auto after = memoryAccounting::take();
+	EXPECT_EQ(after.queueBlocks, before.queueBlocks);
+	EXPECT_EQ(after.queueBytes, before.queueBytes);
+}
+
+TEST_F(MemoryAccountingTest, FramesOfExitedThreadsStillBalance)
+{
+	constexpr size_t threads = 8;
+	constexpr size_t count = 100;
+	auto before = memoryAccounting::take();
+
+	// Every thread's counters are released on exit and taken over by the next one
+	std::vector<task> tasks;
+	for (size_t i = 0; i < threads; ++i)
+	{
+		std::thread allocator(
+			[&]()
+			{
+				for (size_t j = 0; j < count; ++j)
+					tasks.push_back(suspended(static_cast<int64_t>(j)));
+			});
+		allocator.join();
+	}
+
+	auto during = memoryAccounting::take();
+	EXPECT_EQ(during.liveFrames - before.liveFrames, threads * count);
+	EXPECT_EQ(during.totalFrames - before.totalFrames, threads * count);
+
+	for (auto& t : tasks)
+		t.handle().destroy();
+	auto after = memoryAccounting::take();
+	EXPECT_EQ(after.liveFrames, before.liveFrames);
+	EXPECT_EQ(after.frameBytes, before.frameBytes);
+}
+
+TEST(MemoryAccountingSizeTest, SizeClassLimits)
+{
+	EXPECT_EQ(memoryAccounting::sizeClassLimit(0), 64u);
+	EXPECT_EQ(memoryAccounting::sizeClassLimit(6), 4096u);
+	EXPECT_EQ(memoryAccounting::sizeClassLimit(memoryAccounting::frameSizeClasses - 1), 0u);
+}
+
+TEST(MemoryAccountingCompiledOutTest, EnableIsIgnored)
+{
+	if (memoryAccounting::compiled)
+		GTEST_SKIP() << "built with BUILD_MEMORY_ACCOUNTING";
+
+	memoryAccounting::enable(true);
+	EXPECT_FALSE(memoryAccounting::enabled());
+	auto t = suspended(1);
+	auto during = memoryAccounting::take();
+	EXPECT_EQ(during.liveFrames, 0u);
+	EXPECT_EQ(during.totalFrames, 0u);
+	t.handle().destroy();
+	memoryAccounting::enable(false);
+}
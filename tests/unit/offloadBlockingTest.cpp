@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+
+#include "core/offload-blocking.h"
+#include "core/strand-executor.h"
+
+#include "wait-for.h"
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+using namespace cs;
+
+TEST(OffloadBlockingTest, RunsOnBlockingPoolAndResumesOnOrigin)
+{
+	blockingPool pool;
+	pool.start(2);
+	strandExecutor strand;
+	std::atomic<bool> completed = false;
+	std::thread::id strandThread;
+	std::thread::id blockingThread;
+	std::thread::id resumedThread;
+	executor* resumedOn = nullptr;
+	int result = 0;
+
+	auto coro = [&]() -> task
+	{
+		strandThread = std::this_thread::get_id();
+		result = co_await offload_blocking(pool,
+			[&]()
+			{
+				blockingThread = std::this_thread::get_id();
+				std::this_thread::sleep_for(std::chrono::milliseconds(5));
+				return 42;
+			});
+		resumedThread = std::this_thread::get_id();
+		resumedOn = &executor::current();
+		completed = true;
+	};
+
+	strand.execute(coro());
+	waitFor(completed);
+	EXPECT_EQ(result, 42);
+	EXPECT_NE(blockingThread, strandThread);
+	EXPECT_EQ(resumedThread, strandThread);
+	EXPECT_EQ(resumedOn, &strand);
+	pool.stop();
+}
+
+TEST(OffloadBlockingTest, RethrowsInCoroutine)
+{
+	blockingPool pool;
+	pool.start(1);
+	strandExecutor strand;
+	std::atomic<bool> completed = false;
+	bool caught = false;
+
+	auto coro = [&]() -> task
+	{
+		try
+		{
+			co_await offload_blocking(pool, []() { throw std::runtime_error("blocking call failed"); });
+		}
+		catch (const std::runtime_error&)
+		{
+			caught = true;
+		}
+		completed = true;
+	};
+
+	strand.execute(coro());
+	waitFor(completed);
+	EXPECT_TRUE(caught);
+	pool.stop();
+}
+
+TEST(OffloadBlockingTest, RunsInlineWithoutPool)
+{
+	blockingPool pool;
+	strandExecutor strand;
+	std::atomic<bool> completed = false;
+	std::thread::id strandThread;
+	std::thread::id calledThread;
+
+	auto coro = [&]() -> task
+	{
+		strandThread = std::this_thread::get_id();
+		co_await offload_blocking(pool, [&]() { calledThread = std::this_thread::get_id(); });
+		completed = true;
+	};
+
+	strand.execute(coro());
+	waitFor(completed);
+	EXPECT_EQ(calledThread, strandThread);
+}
+
+TEST(OffloadBlockingTest, StopRunsQueuedTasks)
+{
+	blockingPool pool;
+	pool.start(1);
+	std::atomic<int> ran = 0;
+
+	pool.submit([]() { std::this_thread::sleep_for(std::chrono::milliseconds(20)); });
+	for (int i = 0; i < 3; ++i)
+	{
+		pool.submit([&]() { ran++; });
+	}
+
+	pool.stop();
+	EXPECT_EQ(ran.load(), 3);
+}
@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+
+#include "core/parallel.h"
+#include "core/pool-executor.h"
+#include "core/strand-executor.h"
+
+#include "wait-for.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace cs;
+
+namespace
+{
+class ParallelTest : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		tp_ = std::make_shared<threadPool>(4);
+		pool_ = std::make_shared<poolExecutor>(tp_);
+		tp_->start();
+	}
+
+	void TearDown() override { tp_->stop(); }
+
+	std::shared_ptr<threadPool> tp_;
+	std::shared_ptr<poolExecutor> pool_;
+};
+} // namespace
+
+TEST_F(ParallelTest, ForVisitsEveryIndexOnce)
+{
+	constexpr size_t size = 100000;
+
+	for (size_t grain : { size_t { 0 }, size_t { 1000 }, size_t { 7 } })
+	{
+		std::vector<std::atomic<int>> visits(size);
+		std::atomic<bool> completed = false;
+
+		auto coro = [&]() -> task
+		{
+			co_await parallel_for(size_t { 0 }, size, grain, [&](size_t i) { visits[i].fetch_add(1, std::memory_order_relaxed); });
+			completed = true;
+		};
+
+		pool_->execute(coro());
+		waitFor(completed, 5000);
+		for (size_t i = 0; i < size; ++i)
+			ASSERT_EQ(visits[i].load(), 1) << "index " << i << ", grain " << grain;
+	}
+}
+
+TEST_F(ParallelTest, ReduceSumsRange)
+{
+	constexpr int64_t size = 1000000;
+	std::atomic<bool> completed = false;
+	int64_t sum = 0;
+
+	auto coro = [&]() -> task
+	{
+		sum = co_await parallel_reduce(int64_t { 0 }, size, 0, int64_t { 0 }, [](int64_t i) { return i; }, [](int64_t a, int64_t b) { return a + b; });
+		completed = true;
+	};
+
+	pool_->execute(coro());
+	waitFor(completed, 5000);
+	EXPECT_EQ(sum, size * (size - 1) / 2);
+}
+
+TEST_F(ParallelTest, EmptyRangeDoesNotSuspend)
+{
+	bool called = false;
+	bool completed = false;
+
+	auto coro = [&]() -> task
+	{
+		co_await parallel_for(10, 10, 1, [&](int) { called = true; });
+		int value = co_await parallel_reduce(5, 5, 1, 42, [](int i) { return i; }, [](int a, int b) { return a + b; });
+		EXPECT_EQ(value, 42);
+		completed = true;
+	};
+
+	// Runs inline: nothing is spawned for an empty range
+	auto t = coro();
+	t.resume();
+	EXPECT_TRUE(completed);
+	EXPECT_FALSE(called);
+	t.handle().destroy();
+}
+
+TEST_F(ParallelTest, ExceptionIsRethrownInAwaiter)
+{
+	std::atomic<bool> completed = false;
+	bool caught = false;
+
+	auto coro = [&]() -> task
+	{
+		try
+		{
+			co_await parallel_for(0, 1000, 10,
+				[](int i)
+				{
+					if (i == 500)
+						throw std::runtime_error("boom");
+				});
+		}
+		catch (const std::runtime_error&)
+		{
+			caught = true;
+		}
+		completed = true;
+	};
+
+	pool_->execute(coro());
+	waitFor(completed, 5000);
+	EXPECT_TRUE(caught);
+}
+
+TEST(ParallelStrandTest, ResumesOnOriginExecutor)
+{
+	strandExecutor strand;
+	std::atomic<bool> completed = false;
+	executor* resumedOn = nullptr;
+	int64_t sum = 0;
+
+	auto coro = [&]() -> task
+	{
+		sum = co_await parallel_reduce(0, 100, 3, int64_t { 0 }, [](int i) { return int64_t { i }; }, [](int64_t a, int64_t b) { return a + b; });
+		resumedOn = &executor::current();
+		completed = true;
+	};
+
+	strand.execute(coro());
+	waitFor(completed);
+	EXPECT_EQ(sum, 4950);
+	EXPECT_EQ(resumedOn, &strand);
+}
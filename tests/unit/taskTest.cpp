@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+
+#include "core/coro-mutex.h"
+#include "core/inline-executor.h"
+#include "core/task-manager.h"
+#include "core/thread-pool.h"
+
+#include "wait-for.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <utility>
+
+using namespace cs;
+
+namespace
+{
+// Counts its destruction, as a coroutine parameter it lives exactly as long as the frame
+struct frameGuard
+{
+	explicit frameGuard(std::atomic<int>* destroyed)
+	: destroyed_ { destroyed }
+	{ }
+
+	frameGuard(frameGuard&& other) noexcept
+	: destroyed_ { std::exchange(other.destroyed_, nullptr) }
+	{ }
+
+	~frameGuard()
+	{
+		if (destroyed_ != nullptr)
+			++*destroyed_;
+	}
+
+private:
+	std::atomic<int>* destroyed_;
+};
+
+task finishing(frameGuard)
+{
+	co_return;
+}
+
+task yielding(frameGuard, int times, std::atomic<bool>& completed)
+{
+	for (int i = 0; i < times; ++i)
+		co_await yield();
+	completed = true;
+}
+
+task waitingOn(frameGuard, coroMutex& mtx)
+{
+	co_await mtx.lock();
+	mtx.unlock();
+}
+} // namespace
+
+TEST(TaskTest, DetachedFrameIsDestroyedOnCompletion)
+{
+	inlineExecutor exec;
+	std::atomic<int> destroyed = 0;
+
+	exec.execute(finishing(frameGuard { &destroyed }));
+	EXPECT_EQ(destroyed, 1);
+}
+
+TEST(TaskTest, DetachedFrameLivesWhileSuspended)
+{
+	inlineExecutor exec;
+	coroMutex mtx;
+	[[maybe_unused]] auto holder = mtx.lock();
+	std::atomic<int> destroyed = 0;
+
+	exec.execute(waitingOn(frameGuard { &destroyed }, mtx));
+	EXPECT_EQ(destroyed, 0);
+
+	// Resumes the waiter inline, it completes and frees its frame
+	mtx.unlock();
+	EXPECT_EQ(destroyed, 1);
+	EXPECT_FALSE(mtx.locked());
+}
+
+TEST(TaskTest, OwnedFrameIsKeptAfterCompletion)
+{
+	std::atomic<int> destroyed = 0;
+
+	auto t = finishing(frameGuard { &destroyed });
+	t.resume();
+	EXPECT_TRUE(t.done());
+	EXPECT_EQ(destroyed, 0);
+
+	t.handle().destroy();
+	EXPECT_EQ(destroyed, 1);
+}
+
+TEST(TaskTest, DetachedFrameSurvivesYieldsOnPool)
+{
+	auto tp = std::make_shared<threadPool>(2);
+	taskManager::instance().init(tp);
+	tp->start();
+
+	std::atomic<int> destroyed = 0;
+	std::atomic<bool> completed = false;
+
+	// Every yield hands the frame to the pool, where either worker may resume it
+	taskManager::instance().execute(yielding(frameGuard { &destroyed }, 10000, completed));
+	waitFor(completed, 5000);
+
+	// completed is set right before the final suspend point
+	int waited = 0;
+	while (destroyed.load() == 0 && waited < 1000)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		waited++;
+	}
+	tp->stop();
+	EXPECT_EQ(destroyed.load(), 1);
+}
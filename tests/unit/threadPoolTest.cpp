@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+
+#include "core/thread-pool.h"
+
+#include "wait-for.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+
+using namespace cs;
+
+TEST(ThreadPoolTest, RunNextIsStolenWhileWorkerIsBusy)
+{
+	threadPool tp(2);
+	tp.start();
+
+	std::atomic<bool> completed = false;
+	std::atomic<bool> timedOut = false;
+	std::thread::id parent;
+	std::thread::id child;
+
+	tp.pushTask(
+		[&]()
+		{
+			parent = std::this_thread::get_id();
+			// Lands in the run-next slot of this worker, which stays busy until the task has run
+			tp.pushTask(
+				[&]()
+				{
+					child = std::this_thread::get_id();
+					completed = true;
+				});
+			int waited = 0;
+			while (!completed.load() && waited < 1000)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				waited++;
+			}
+			timedOut = !completed.load();
+		});
+
+	waitFor(completed);
+	tp.stop();
+	EXPECT_FALSE(timedOut.load());
+	EXPECT_NE(parent, child);
+}
+
+TEST(ThreadPoolTest, RespawningTaskDoesNotStarveQueue)
+{
+	threadPool tp(1);
+	tp.start();
+
+	std::atomic<bool> stop = false;
+	std::atomic<bool> queuedRan = false;
+
+	std::function<void()> respawn = [&]()
+	{
+		if (!stop)
+			tp.pushTask(respawn);
+	};
+
+	tp.pushTask(
+		[&]()
+		{
+			tp.pushTask([&]() { queuedRan = true; });
+			tp.pushTask(respawn);
+		});
+
+	waitFor(queuedRan);
+	stop = true;
+	tp.stop();
+}
+
+TEST(ThreadPoolTest, ElasticGrowsUnderLoadAndShrinksWhenIdle)
+{
+	threadPool tp(1);
+	tp.setElastic({ 1, 4, std::chrono::milliseconds(20), std::chrono::milliseconds(1) });
+	tp.start();
+	EXPECT_EQ(tp.workersCount(), 1u);
+
+	constexpr int tasks = 40;
+	std::atomic<int> done = 0;
+	for (int i = 0; i < tasks; ++i)
+	{
+		tp.pushTask(
+			[&]()
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(2));
+				done++;
+			});
+	}
+
+	int waited = 0;
+	while ((done.load() != tasks || tp.workersCount() != 1) && waited < 2000)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		waited++;
+	}
+	ASSERT_NE(waited, 2000) << "Timeout waiting for the pool to drain and shrink";
+
+	auto stats = tp.getStats();
+	tp.stop();
+	EXPECT_GT(stats.peakWorkers, 1u);
+	EXPECT_LE(stats.peakWorkers, 4u);
+	EXPECT_GE(stats.grows, 1u);
+	EXPECT_EQ(stats.grows, stats.shrinks);
+	EXPECT_EQ(stats.events.size(), stats.grows + stats.shrinks);
+}
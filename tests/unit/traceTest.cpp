@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+
+#include "core/coro-mutex.h"
+#include "core/strand-executor.h"
+#include "core/task.h"
+#include "core/trace.h"
+
+#include "wait-for.h"
+
+#include <atomic>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace cs;
+
+namespace
+{
+size_t occurrences(const std::string& text, const std::string& pattern)
+{
+	size_t count = 0;
+	for (size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + pattern.size()))
+		++count;
+	return count;
+}
+} // namespace
+
+TEST(TraceTest, RecordsLockEvents)
+{
+	coroMutex mtx;
+	trace::clear();
+	trace::enable(true);
+	EXPECT_EQ(trace::enabled(), trace::compiled);
+
+	auto coro = [&]() -> task
+	{
+		co_await mtx.lock();
+		mtx.unlock();
+	};
+	auto t = coro();
+	t.resume();
+	ASSERT_TRUE(t.done());
+	t.handle().destroy();
+	trace::enable(false);
+
+	std::ostringstream out;
+	if (!trace::compiled)
+	{
+		// Compiled out: nothing recorded, nothing to export
+		EXPECT_FALSE(trace::writeChrome(out));
+		EXPECT_TRUE(out.str().empty());
+		return;
+	}
+
+	ASSERT_TRUE(trace::writeChrome(out));
+	auto json = out.str();
+	EXPECT_EQ(occurrences(json, "\"lock request\""), 1u);
+	EXPECT_EQ(occurrences(json, "\"ph\":\"b\""), 1u);
+	EXPECT_EQ(occurrences(json, "\"ph\":\"e\""), 1u);
+}
+
+TEST(TraceTest, BudgetYieldKeepsLockEventsBalanced)
+{
+	if (!trace::compiled)
+		GTEST_SKIP() << "built without BUILD_TRACE";
+
+	// Every lock after the first one in a resume yields through the queue
+	strandExecutor strand;
+	strand.setBudget(1);
+	coroMutex mtx;
+	std::atomic<bool> completed = false;
+
+	auto locking = [&]() -> task
+	{
+		for (int i = 0; i < 4; ++i)
+		{
+			co_await mtx.lock();
+			mtx.unlock();
+		}
+		completed = true;
+	};
+
+	trace::clear();
+	trace::enable(true);
+	strand.execute(locking());
+	waitFor(completed);
+	trace::enable(false);
+
+	std::ostringstream out;
+	ASSERT_TRUE(trace::writeChrome(out));
+	auto json = out.str();
+	EXPECT_EQ(occurrences(json, "\"lock request\""), 4u);
+	EXPECT_EQ(occurrences(json, "\"ph\":\"b\""), 4u);
+	EXPECT_EQ(occurrences(json, "\"ph\":\"e\""), 4u);
+}
+
+TEST(TraceTest, RingKeepsNewestEvents)
+{
+	if (!trace::compiled)
+		GTEST_SKIP() << "built without BUILD_TRACE";
+
+	trace::clear();
+	trace::enable(true);
+	std::thread recorder(
+		[]()
+		{
+			for (size_t i = 0; i < trace::ringCapacity + 10; ++i)
+				trace::record(trace::event::steal, nullptr, i);
+		});
+	recorder.join();
+	trace::enable(false);
+
+	std::ostringstream out;
+	ASSERT_TRUE(trace::writeChrome(out));
+	auto json = out.str();
+	EXPECT_EQ(occurrences(json, "\"steal\""), trace::ringCapacity);
+	EXPECT_EQ(occurrences(json, "\"victim\":9}"), 0u);
+	EXPECT_EQ(occurrences(json, "\"victim\":10}"), 1u);
+}
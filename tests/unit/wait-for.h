@@ -0,0 +1,19 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+// Polls flag every millisecond, fails the test after maxWaitMs
+inline void waitFor(const std::atomic<bool>& flag, int maxWaitMs = 1000)
+{
+	int waited = 0;
+	while (!flag.load() && waited < maxWaitMs)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		waited++;
+	}
+	ASSERT_NE(waited, maxWaitMs) << "Timeout waiting for completion";
+}
@@ -5,6 +5,19 @@ from datetime import datetime
 import sys
 import os
 
+TARGET_NAMES = {
+	'm': 'std::mutex',
+	'cm': 'coroMutex',
+	'cmr': 'coroMutex run()',
+	'lt': 'coroLockTable',
+	'ttas': 'TTAS spinlock',
+	'ticket': 'ticket lock',
+	'mcs': 'MCS lock',
+	'futex': 'futex mutex',
+	'sm': 'std::shared_mutex',
+	'spawn': 'coroutine spawn',
+}
+
 def parse_filename(filename):
 	basename = os.path.basename(filename)
 	pattern = r'(\d{4}-\d{2}-\d{2}_\d{2}-\d{2}-\d{2})_threads_(\d+)_coro_(\d+)_shared_(\d+)_target_(\w+)_dump_(\d+)_worktime_(\d+)\.csv'
@@ -42,7 +55,7 @@ def plot_benchmark_results(filename):
 
 	plt.plot(timestamps, total, label='Total', color='black', linewidth=2, linestyle='--')
 
-	target_name = "std::mutex" if params['target'] == "m" else "coroMutex"
+	target_name = TARGET_NAMES.get(params['target'], params['target'])
 
 	plt.title(
 		f"Benchmark {target_name}\n"
@@ -4,6 +4,19 @@ import re
 import sys
 import os
 
+TARGET_NAMES = {
+	'm': 'std::mutex',
+	'cm': 'coroMutex',
+	'cmr': 'coroMutex run()',
+	'lt': 'coroLockTable',
+	'ttas': 'TTAS spinlock',
+	'ticket': 'ticket lock',
+	'mcs': 'MCS lock',
+	'futex': 'futex mutex',
+	'sm': 'std::shared_mutex',
+	'spawn': 'coroutine spawn',
+}
+
 def parse_filename(filename):
 	basename = os.path.basename(filename)
 	pattern = r'(\d{4}-\d{2}-\d{2}_\d{2}-\d{2}-\d{2})_threads_(\d+)_coro_(\d+)_shared_(\d+)_target_(\w+)_dump_(\d+)_worktime_(\d+)\.usage'
@@ -65,7 +78,7 @@ def plot_usage_results(filename):
 					f'{height:,} μs',
 					ha='center', va='bottom')
 
-	target_name = "std::mutex" if run_params['target'] == "m" else "coroMutex"
+	target_name = TARGET_NAMES.get(run_params['target'], run_params['target'])
 
 	title = (
 		f"Resource Usage ({target_name})\n"
@@ -0,0 +1,73 @@
+import pandas as pd
+import matplotlib.pyplot as plt
+import json
+import sys
+import os
+
+TARGET_NAMES = {
+	'm': 'std::mutex',
+	'cm': 'coroMutex',
+	'cmr': 'coroMutex run()',
+	'lt': 'coroLockTable',
+	'ttas': 'TTAS spinlock',
+	'ticket': 'ticket lock',
+	'mcs': 'MCS lock',
+	'futex': 'futex mutex',
+	'sm': 'std::shared_mutex',
+}
+
+PERCENTILES = [
+	('response_p50_ns', 'p50'),
+	('response_p90_ns', 'p90'),
+	('response_p99_ns', 'p99'),
+	('response_p999_ns', 'p99.9'),
+]
+
+def plot_open_loop(filename):
+	"""Latency-vs-load curve of an _open_loop.csv, run parameters are taken from the _open_loop.json next to it"""
+	df = pd.read_csv(filename)
+	if df.empty:
+		print("No open-loop points in the file")
+		return
+
+	title = "Open loop"
+	json_filename = filename.replace('.csv', '.json')
+	if os.path.exists(json_filename):
+		with open(json_filename, 'r') as f:
+			params = json.load(f)
+		target_name = TARGET_NAMES.get(params['target'], params['target'])
+		title = (
+			f"Open loop {target_name}, {params['arrivals']} arrivals\n"
+			f"Threads: {params['threads']}, Shared objects: {params['shared']}, Trial: {params['trial_ms']}ms"
+		)
+
+	plt.figure(figsize=(12, 8))
+
+	for column, label in PERCENTILES:
+		plt.plot(df['offered_rate'], df[column] / 1000.0, marker='o', label=label)
+
+	saturated = df[df['saturated'] == 1]
+	if not saturated.empty:
+		plt.axvline(saturated['offered_rate'].iloc[0], color='red', linestyle='--', label='Saturated (offered)')
+
+	plt.title(title)
+	plt.xlabel('Offered load (requests/s)')
+	plt.ylabel('Response time from intended start (μs)')
+	plt.xscale('log')
+	plt.yscale('log')
+	plt.legend()
+	plt.grid(True, which='both')
+
+	plt.tight_layout()
+
+	output_filename = filename.replace('.csv', '.png')
+	plt.savefig(output_filename)
+	print(f"Plot saved to {output_filename}")
+	plt.close()
+
+if __name__ == "__main__":
+	if len(sys.argv) != 2:
+		print("Usage: python gen_open_loop_graphic.py <input_filename_open_loop.csv>")
+		sys.exit(1)
+
+	plot_open_loop(sys.argv[1])
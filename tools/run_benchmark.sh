@@ -56,6 +56,8 @@ mkdir -p "$result_dir/img"
 mkdir -p "$result_dir/res"
 
 mv runs/*.csv "$result_dir/res/" 2>/dev/null || true
+mv runs/*.bin "$result_dir/res/" 2>/dev/null || true
 mv runs/*.usage "$result_dir/res/" 2>/dev/null || true
+mv runs/*.latency "$result_dir/res/" 2>/dev/null || true
 mv runs/*.log "$result_dir/res/" 2>/dev/null || true
 mv runs/*.png "$result_dir/img/" 2>/dev/null || true
\ No newline at end of file